@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <chrono>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "CoarsePassTracker.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	number of idle checks of the watching thread per idle time
+#define NUM_IDLE_CHECKS 4
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS CoarsePassTracker MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS CoarsePassTracker STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS CoarsePassTracker MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+CoarsePassTracker::CoarsePassTracker( int y, int t, const DoneCallback &doneCallback,
+										int idleMilliseconds /*= DEFAULT_COARSE_PASS_IDLE_MS*/,
+										int firstRowMilliseconds /*= DEFAULT_COARSE_PASS_FIRST_ROW_MS*/ )
+	: y( y ), t( std::max( y, t ) ), numRowsLeft( std::max( 0, t - y ) ),
+		idleMilliseconds( std::max( 1, idleMilliseconds ) ), firstRowMilliseconds( std::max( 1, firstRowMilliseconds ) ),
+		lastRowTime( CoarsePassTracker::getTime() ), isAnyRowDone( false ),
+		doneCallback( doneCallback ), isDone( false ), isStopped( false )
+{
+	this->isRowDone.reset( new std::atomic<bool>[this->t - this->y] );
+	for( int i = 0 ; i < this->t - this->y ; i++ )
+		this->isRowDone[i] = false;
+
+	//	started last, it uses all of the above
+	this->watcher = std::thread( &CoarsePassTracker::watch, this );
+}
+CoarsePassTracker::~CoarsePassTracker()
+{
+	{
+		std::lock_guard<std::mutex> lock( this->stopMutex );
+		this->isStopped = true;
+	}
+	this->stopSignal.notify_all();
+	this->watcher.join();
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	mark row %y% rendered, rows outside of the pass are ignored
+void CoarsePassTracker::markRowDone( int y )
+{
+	if( y < this->y || y >= this->t )
+		return;
+
+	this->lastRowTime = CoarsePassTracker::getTime();
+	this->isAnyRowDone = true;
+
+	//	a row rendered again ( e.g. by another viewer ) counts once
+	if( !this->isRowDone[y - this->y].exchange( true ) && --this->numRowsLeft == 0 )
+		this->finish();
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	call back once the pass is idle, until stopped
+void CoarsePassTracker::watch()
+{
+	std::unique_lock<std::mutex> lock( this->stopMutex );
+	while( !this->isStopped && !this->isDone )
+	{
+		this->stopSignal.wait_for( lock, std::chrono::milliseconds( std::max( 1, this->idleMilliseconds / NUM_IDLE_CHECKS ) ) );
+		if( this->isStopped )
+			return;
+
+		int64_t idleTime = CoarsePassTracker::getTime() - this->lastRowTime,
+				maxIdleTime = int64_t( this->isAnyRowDone ? this->idleMilliseconds : this->firstRowMilliseconds ) * 1000000;
+		if( idleTime >= maxIdleTime )
+		{
+			//	not under the lock, the callback may take a while
+			lock.unlock();
+			this->finish();
+			return;
+		}
+	}
+}
+
+//	call back unless it has been already
+void CoarsePassTracker::finish()
+{
+	if( !this->isDone.exchange( true ) )
+		this->doneCallback();
+}
+
+//	get steady clock time ( in nanosecond )
+int64_t CoarsePassTracker::getTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS CoarsePassTracker MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,184 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___CoarsePassTracker_h)
+#define ___CoarsePassTracker_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <stdint.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	default time ( in millisecond ) without a row rendered after which the
+//		coarse pass is done, and before the first row is rendered
+#define DEFAULT_COARSE_PASS_IDLE_MS 250
+#define DEFAULT_COARSE_PASS_FIRST_ROW_MS 2000
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class CoarsePassTracker
+//
+//---------------------------------------------------------------------
+
+//	tells once when the coarse pass of a progressive render is done. Every
+//		row of the box rendered is marked in a bitmap, and the pass is done
+//		when all of them are, or when no row has been rendered for a while,
+//		since many rows are never rendered by the op ( rows taken from Nuke's
+//		row cache, rows a zoomed out viewer skips, aborted rows, and rows
+//		requested but never pulled )
+class CoarsePassTracker
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+		//	called once when the pass is done, from the thread of the last row
+		//		or from the watching thread
+		typedef std::function<void()> DoneCallback;
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//	rows of the pass, [y,t)
+		int y, t;
+
+		//	is every row rendered, and number of rows not rendered yet
+		std::unique_ptr<std::atomic<bool>[]> isRowDone;
+		std::atomic<int> numRowsLeft;
+
+		//	time ( in millisecond ) without a row rendered after which the
+		//		pass is done, and before the first row is rendered
+		int idleMilliseconds, firstRowMilliseconds;
+
+		//	steady clock time ( in nanosecond ) of the last row rendered, or of
+		//		the start when no row has been
+		std::atomic<int64_t> lastRowTime;
+		std::atomic<bool> isAnyRowDone;
+
+		//	callback and whether it has been called
+		DoneCallback doneCallback;
+		std::atomic<bool> isDone;
+
+		//	guard and signal of stopping the watching thread
+		std::mutex stopMutex;
+		std::condition_variable stopSignal;
+		bool isStopped;
+
+		//	thread calling back once the pass is idle
+		std::thread watcher;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		//	start tracking rows [%y%,%t%)
+		CoarsePassTracker( int y, int t, const DoneCallback &doneCallback,
+							int idleMilliseconds = DEFAULT_COARSE_PASS_IDLE_MS,
+							int firstRowMilliseconds = DEFAULT_COARSE_PASS_FIRST_ROW_MS );
+
+		//	the callback isn't called anymore once destroyed
+		~CoarsePassTracker();
+
+	private:
+		//	not copyable, the watching thread refers to it
+		CoarsePassTracker( const CoarsePassTracker & );
+		CoarsePassTracker &operator=( const CoarsePassTracker & );
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	is the pass done
+		bool getIsDone() const
+		{	return this->isDone;	}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	mark row %y% rendered, rows outside of the pass are ignored
+		void markRowDone( int y );
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+		//	call back once the pass is idle, until stopped
+		void watch();
+
+		//	call back unless it has been already
+		void finish();
+
+		//	get steady clock time ( in nanosecond )
+		static int64_t getTime();
+
+};
+//---------------------------------------------------------------------
+//	END class CoarsePassTracker
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,370 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "DisplacementCacheFile.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	magic and version of the cache file, the version is increased whenever
+//		the layout changes so old files are written again
+#define DISPLACEMENT_CACHE_MAGIC "YNXDISP"
+#define DISPLACEMENT_CACHE_VERSION 1
+
+//	header of the cache file, followed by the two encoded displacements
+//		of every pixel of the box
+struct DisplacementCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t key;
+	int32_t x, y, r, t;
+	double scale;
+};
+
+//	a cache file in a directory, for eviction
+struct DisplacementCacheEntry
+{
+	std::string path;
+	uint64_t size;
+	int64_t accessTime;
+};
+
+//	get maximum size of all cache files of a directory ( in bytes )
+static inline uint64_t getSizeLimit()
+{
+	long sizeLimitMB = DEFAULT_DISPLACEMENT_CACHE_SIZE_LIMIT_MB;
+	const char *sizeLimitEnv = getenv( DISPLACEMENT_CACHE_SIZE_LIMIT_ENV );
+	if( sizeLimitEnv != NULL && atol( sizeLimitEnv ) >= 0 )
+		sizeLimitMB = atol( sizeLimitEnv );
+	return uint64_t( sizeLimitMB ) * 1024 * 1024;
+}
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS DisplacementCacheFile MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS DisplacementCacheFile STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//	guard for the process wide files below
+std::mutex DisplacementCacheFile::sMutex;
+
+//	process wide files still used by some op, keyed by path
+std::unordered_map<std::string, std::weak_ptr<const DisplacementCacheFile> > DisplacementCacheFile::sFiles;
+
+//---------------------------------------------------------------------
+//
+//	CLASS DisplacementCacheFile MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+DisplacementCacheFile::DisplacementCacheFile() : x( 0 ), y( 0 ), r( 0 ), t( 0 ), encodedDisplacements( NULL ),
+													mappedData( NULL ), mappedSize( 0 )
+{
+
+}
+DisplacementCacheFile::~DisplacementCacheFile()
+{
+	if( this->mappedData != NULL )
+		munmap( this->mappedData, this->mappedSize );
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	get the file of %key% in %directory% shared by the whole process
+//	returns an empty pointer if there is no such file
+std::shared_ptr<const DisplacementCacheFile> DisplacementCacheFile::open( const std::string &directory, uint64_t key )
+{
+	std::string path = DisplacementCacheFile::getPath( directory, key );
+
+	//	mapping under the lock makes every other op of the file wait for
+	//		the one mapping it instead of mapping it again
+	std::lock_guard<std::mutex> lock( DisplacementCacheFile::sMutex );
+	std::shared_ptr<const DisplacementCacheFile> file = DisplacementCacheFile::sFiles[path].lock();
+	if( file )
+		return file;
+
+	std::shared_ptr<DisplacementCacheFile> mappedFile( new DisplacementCacheFile() );
+	if( !mappedFile->map( path, key ) )
+		return std::shared_ptr<const DisplacementCacheFile>();
+
+	//	mark the file most recently used, failing ( e.g. read only
+	//		directory ) only makes it evicted earlier
+	utimensat( AT_FDCWD, path.c_str(), NULL, 0 );
+
+	//	forget files no op uses anymore
+	for( std::unordered_map<std::string, std::weak_ptr<const DisplacementCacheFile> >::iterator it = DisplacementCacheFile::sFiles.begin() ;
+			it != DisplacementCacheFile::sFiles.end() ; )
+	{
+		if( it->second.expired() )
+			it = DisplacementCacheFile::sFiles.erase( it );
+		else
+			++it;
+	}
+	DisplacementCacheFile::sFiles[path] = mappedFile;
+	return mappedFile;
+}
+
+//	save %encodedDisplacements% ( displacement of every pixel of box 
+//		[%x%,%r%) x [%y%,%t%) to its source position encoded with
+//		%displacementEncoding%, in rows from the bottom, both
+//		INVALID_ENCODED_DISPLACEMENT for a pixel that can't be warped ) as
+//		the file of %key% in %directory%, then remove the least recently
+//		used files beyond the size limit
+//	returns the file, or an empty pointer if it can't be written or
+//		positions are off by more than %maxError% ( in pixel )
+std::shared_ptr<const DisplacementCacheFile> DisplacementCacheFile::write( const std::string &directory, uint64_t key,
+																			int x, int y, int r, int t,
+																			const int16_t *encodedDisplacements,
+																			const DisplacementEncoding &displacementEncoding,
+																			double maxError )
+{
+	if( r <= x || t <= y || displacementEncoding.getMaxError() > maxError )
+		return std::shared_ptr<const DisplacementCacheFile>();
+	size_t numEncodedDisplacements = size_t( r - x ) * size_t( t - y ) * 2;
+
+	DisplacementCacheHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, DISPLACEMENT_CACHE_MAGIC, sizeof( header.magic ) );
+	header.version = DISPLACEMENT_CACHE_VERSION;
+	header.key = key;
+	header.x = x;
+	header.y = y;
+	header.r = r;
+	header.t = t;
+	header.scale = displacementEncoding.scale;
+
+	//	the directory is created on first use
+	mkdir( directory.c_str(), 0777 );
+
+	//	temporary file is unique per machine and process so concurrent farm
+	//		tasks don't clash
+	char hostName[256] = "";
+	gethostname( hostName, sizeof( hostName ) - 1 );
+	std::string path = DisplacementCacheFile::getPath( directory, key ),
+				temporaryPath = path + ".tmp." + hostName + "." + std::to_string( getpid() );
+	FILE *file = fopen( temporaryPath.c_str(), "wb" );
+	if( file == NULL )
+		return std::shared_ptr<const DisplacementCacheFile>();
+
+	bool isWritten = fwrite( &header, sizeof( header ), 1, file ) == 1 &&
+						fwrite( encodedDisplacements, sizeof( int16_t ), numEncodedDisplacements, file ) == numEncodedDisplacements;
+	isWritten = ( fclose( file ) == 0 ) && isWritten;
+	if( !isWritten || rename( temporaryPath.c_str(), path.c_str() ) != 0 )
+	{
+		unlink( temporaryPath.c_str() );
+		return std::shared_ptr<const DisplacementCacheFile>();
+	}
+
+	DisplacementCacheFile::evict( directory, path );
+
+	return DisplacementCacheFile::open( directory, key );
+}
+
+//	get source positions of pixels [%x%,%r%) of row %y%, pixels outside
+//		of the box can't be warped
+void DisplacementCacheFile::getSourcePixels( int y, int x, int r, Vector2 *sourcePixels_ret, bool *isWarped_ret ) const
+{
+	if( y < this->y || y >= this->t )
+	{
+		std::fill( isWarped_ret, isWarped_ret + ( r - x ), false );
+		return;
+	}
+
+	const int16_t *rowDisplacements = this->encodedDisplacements + size_t( y - this->y ) * size_t( this->r - this->x ) * 2;
+	for( int i = 0 ; i < r - x ; i++ )
+	{
+		int pixelX = x + i;
+		isWarped_ret[i] = pixelX >= this->x && pixelX < this->r;
+		if( !isWarped_ret[i] )
+			continue;
+
+		const int16_t *encoded = rowDisplacements + ( pixelX - this->x ) * 2;
+		isWarped_ret[i] = encoded[0] != INVALID_ENCODED_DISPLACEMENT;
+		if( isWarped_ret[i] )
+			sourcePixels_ret[i] = this->displacementEncoding.decode( Vector2( pixelX, y ), encoded );
+	}
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	map %path% if it is a complete file of %key%
+//	returns false if there is no such file
+bool DisplacementCacheFile::map( const std::string &path, uint64_t key )
+{
+	int fileDescriptor = ::open( path.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 )
+		return false;
+
+	struct stat fileStat;
+	if( fstat( fileDescriptor, &fileStat ) != 0 || size_t( fileStat.st_size ) < sizeof( DisplacementCacheHeader ) )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	//	the mapping stays valid after the file is closed, and after it is
+	//		evicted by another process
+	size_t size = size_t( fileStat.st_size );
+	void *data = mmap( NULL, size, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( data == MAP_FAILED )
+		return false;
+
+	//	check the file is of this key and complete
+	const DisplacementCacheHeader *header = static_cast<const DisplacementCacheHeader *>( data );
+	if( memcmp( header->magic, DISPLACEMENT_CACHE_MAGIC, sizeof( header->magic ) ) != 0 ||
+		header->version != DISPLACEMENT_CACHE_VERSION ||
+		header->key != key ||
+		header->r <= header->x || header->t <= header->y ||
+		size != sizeof( DisplacementCacheHeader ) + size_t( header->r - header->x ) * size_t( header->t - header->y ) * 2 * sizeof( int16_t ) )
+	{
+		munmap( data, size );
+		return false;
+	}
+
+	this->mappedData = data;
+	this->mappedSize = size;
+	this->x = header->x;
+	this->y = header->y;
+	this->r = header->r;
+	this->t = header->t;
+	this->displacementEncoding.scale = header->scale;
+	this->encodedDisplacements = reinterpret_cast<const int16_t *>( static_cast<const char *>( data ) + sizeof( DisplacementCacheHeader ) );
+	return true;
+}
+
+//	remove the least recently used files of %directory% until all of
+//		them fit in the size limit, %keptPath% is never removed
+void DisplacementCacheFile::evict( const std::string &directory, const std::string &keptPath )
+{
+	DIR *directoryStream = opendir( directory.c_str() );
+	if( directoryStream == NULL )
+		return;
+
+	//	every cache file of the directory, temporary files of writers
+	//		in progress don't end with the suffix
+	std::vector<DisplacementCacheEntry> entries;
+	uint64_t totalSize = 0;
+	size_t suffixLength = strlen( DISPLACEMENT_CACHE_FILE_SUFFIX );
+	for( struct dirent *directoryEntry = readdir( directoryStream ) ; directoryEntry != NULL ; directoryEntry = readdir( directoryStream ) )
+	{
+		std::string name = directoryEntry->d_name;
+		if( name.size() <= suffixLength || name.compare( name.size() - suffixLength, suffixLength, DISPLACEMENT_CACHE_FILE_SUFFIX ) != 0 )
+			continue;
+
+		DisplacementCacheEntry entry;
+		entry.path = directory + "/" + name;
+		struct stat fileStat;
+		if( stat( entry.path.c_str(), &fileStat ) != 0 )
+			continue;
+		entry.size = uint64_t( fileStat.st_size );
+		entry.accessTime = int64_t( fileStat.st_mtim.tv_sec ) * 1000000000 + fileStat.st_mtim.tv_nsec;
+		entries.push_back( entry );
+		totalSize += entry.size;
+	}
+	closedir( directoryStream );
+
+	uint64_t sizeLimit = ::getSizeLimit();
+	if( totalSize <= sizeLimit )
+		return;
+
+	//	least recently used first, open marks a file used by touching it
+	std::sort( entries.begin(), entries.end(),
+				[]( const DisplacementCacheEntry &a, const DisplacementCacheEntry &b ) { return a.accessTime < b.accessTime; } );
+	for( size_t i = 0 ; i < entries.size() && totalSize > sizeLimit ; i++ )
+	{
+		if( entries[i].path == keptPath )
+			continue;
+
+		//	another process may have removed it already, it is gone either way
+		unlink( entries[i].path.c_str() );
+		totalSize -= entries[i].size;
+	}
+}
+
+//	get path of the file of %key% in %directory%
+std::string DisplacementCacheFile::getPath( const std::string &directory, uint64_t key )
+{
+	char name[32];
+	snprintf( name, sizeof( name ), "%016llx", (unsigned long long)key );
+	return directory + "/" + name + DISPLACEMENT_CACHE_FILE_SUFFIX;
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS DisplacementCacheFile MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
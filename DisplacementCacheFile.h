@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___DisplacementCacheFile_h)
+#define ___DisplacementCacheFile_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <stdint.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+#include "DisplacementEncoding.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	suffix of the cache files in a cache directory
+#define DISPLACEMENT_CACHE_FILE_SUFFIX ".ynxdisp"
+
+//	default and environment variable of the maximum size of all cache
+//		files of a directory ( in MB )
+#define DEFAULT_DISPLACEMENT_CACHE_SIZE_LIMIT_MB 10240
+#define DISPLACEMENT_CACHE_SIZE_LIMIT_ENV "YNX_DISPLACEMENT_CACHE_MB"
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class DisplacementCacheFile
+//
+//---------------------------------------------------------------------
+
+//	source position of every pixel of a box, saved to a cache directory shared
+//		by every machine rendering the script ( e.g. on the farm ) and memory
+//		mapped read only from there. Positions are stored as DisplacementEncoding
+//		displacements from their pixel, one file per key, where the key covers
+//		everything the positions depend on. Files are written to a temporary
+//		file and renamed so readers never see half of one, and the least
+//		recently used files of the directory are removed once all of them
+//		exceed the size limit ( DISPLACEMENT_CACHE_SIZE_LIMIT_ENV )
+class DisplacementCacheFile
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//	box of the positions, [x,r) x [y,t)
+		int x, y, r, t;
+
+		//	encoding of the positions, two values per pixel in rows from
+		//		the bottom, both INVALID_ENCODED_DISPLACEMENT for a pixel that
+		//		can't be warped
+		DisplacementEncoding displacementEncoding;
+		const int16_t *encodedDisplacements;
+
+		//	memory mapped file
+		void *mappedData;
+		size_t mappedSize;
+
+		//	guard for the process wide files below
+		static std::mutex sMutex;
+
+		//	process wide files still used by some op, keyed by path
+		static std::unordered_map<std::string, std::weak_ptr<const DisplacementCacheFile> > sFiles;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		DisplacementCacheFile();
+
+		~DisplacementCacheFile();
+
+	private:
+		//	not copyable, the mapping is owned
+		DisplacementCacheFile( const DisplacementCacheFile & );
+		DisplacementCacheFile &operator=( const DisplacementCacheFile & );
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get largest error of a position ( in pixel )
+		double getMaxError() const
+		{	return this->displacementEncoding.getMaxError();	}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get the file of %key% in %directory% shared by the whole process
+		//	returns an empty pointer if there is no such file
+		static std::shared_ptr<const DisplacementCacheFile> open( const std::string &directory, uint64_t key );
+
+		//	save %encodedDisplacements% ( displacement of every pixel of box 
+		//		[%x%,%r%) x [%y%,%t%) to its source position encoded with
+		//		%displacementEncoding%, in rows from the bottom, both
+		//		INVALID_ENCODED_DISPLACEMENT for a pixel that can't be warped ) as
+		//		the file of %key% in %directory%, then remove the least recently
+		//		used files beyond the size limit
+		//	returns the file, or an empty pointer if it can't be written or
+		//		positions are off by more than %maxError% ( in pixel )
+		static std::shared_ptr<const DisplacementCacheFile> write( const std::string &directory, uint64_t key,
+																	int x, int y, int r, int t,
+																	const int16_t *encodedDisplacements,
+																	const DisplacementEncoding &displacementEncoding,
+																	double maxError );
+
+		//	get source positions of pixels [%x%,%r%) of row %y%, pixels outside
+		//		of the box can't be warped
+		void getSourcePixels( int y, int x, int r, Vector2 *sourcePixels_ret, bool *isWarped_ret ) const;
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+		//	map %path% if it is a complete file of %key%
+		//	returns false if there is no such file
+		bool map( const std::string &path, uint64_t key );
+
+		//	remove the least recently used files of %directory% until all of
+		//		them fit in the size limit, %keptPath% is never removed
+		static void evict( const std::string &directory, const std::string &keptPath );
+
+		//	get path of the file of %key% in %directory%
+		static std::string getPath( const std::string &directory, uint64_t key );
+
+};
+//---------------------------------------------------------------------
+//	END class DisplacementCacheFile
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
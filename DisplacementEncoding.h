@@ -0,0 +1,117 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___DisplacementEncoding_h)
+#define ___DisplacementEncoding_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	largest encoded displacement component
+#define MAX_ENCODED_DISPLACEMENT 32767
+
+//	encoded displacement component marking a position without one ( e.g.
+//		that can't be warped ), encoding never produces it
+#define INVALID_ENCODED_DISPLACEMENT ( -MAX_ENCODED_DISPLACEMENT - 1 )
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class DisplacementEncoding
+//
+//---------------------------------------------------------------------
+
+//	int16 fixed point encoding of warped positions as displacements from
+//		the position they were warped from, 4 bytes per position instead of
+//		the 16 of a Vector2. One scale is shared by every position of a map
+//		( e.g. a frame ) and chosen from its largest displacement, so the
+//		error is uniform over the map and at most half a step per component.
+//		Fixed point is used rather than half floats, whose error grows with
+//		the displacement
+class DisplacementEncoding
+{
+	public:
+		//	size of an encoding step, in the units of the positions
+		double scale;
+
+	public:
+		//contructors/destructors
+		DisplacementEncoding() : scale( 0 )
+		{
+		}
+
+	public:
+		//	choose the scale for displacements up to %maxDisplacement% along x or y
+		void setMaxDisplacement( double maxDisplacement )
+		{	this->scale = maxDisplacement / MAX_ENCODED_DISPLACEMENT;	}
+
+		//	get largest error of a decoded position ( length, in the units of the positions )
+		double getMaxError() const
+		{	return this->scale * M_SQRT1_2;	}
+
+		//	encode %warpedP% warped from %p% into %encoded_ret%[0] and %encoded_ret%[1],
+		//		displacements beyond the maximum are clamped
+		void encode( const Vector2 &p, const Vector2 &warpedP, int16_t *encoded_ret ) const
+		{
+			if( this->scale == 0 )
+			{
+				encoded_ret[0] = encoded_ret[1] = 0;
+				return;
+			}
+			double encodedX = floor( ( warpedP.x - p.x ) / this->scale + 0.5 ),
+					encodedY = floor( ( warpedP.y - p.y ) / this->scale + 0.5 );
+			encoded_ret[0] = int16_t( std::max( -double( MAX_ENCODED_DISPLACEMENT ), std::min( encodedX, double( MAX_ENCODED_DISPLACEMENT ) ) ) );
+			encoded_ret[1] = int16_t( std::max( -double( MAX_ENCODED_DISPLACEMENT ), std::min( encodedY, double( MAX_ENCODED_DISPLACEMENT ) ) ) );
+		}
+
+		//	decode the warped position of %p% from %encoded%
+		Vector2 decode( const Vector2 &p, const int16_t *encoded ) const
+		{	return Vector2( p.x + encoded[0] * this->scale, p.y + encoded[1] * this->scale );	}
+};
+//---------------------------------------------------------------------
+//	END class DisplacementEncoding
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
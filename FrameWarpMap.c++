@@ -0,0 +1,331 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "FrameWarpMap.h"
+
+//	per thread memory for per row buffers
+#include "ScratchArena.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	states of a block
+#define BLOCK_PENDING 0
+#define BLOCK_WARPING 1
+#define BLOCK_DONE 2
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS FrameWarpMap MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS FrameWarpMap STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS FrameWarpMap MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+FrameWarpMap::FrameWarpMap( int x, int y, int r, int t, double maxDisplacement, const SpanWarp &spanWarp, 
+							const AbortCheck &abortCheck /*= AbortCheck()*/,
+							int numBlockRows /*= DEFAULT_FRAME_WARP_MAP_BLOCK_ROWS*/ )
+	: x( x ), y( y ), r( std::max( x, r ) ), t( std::max( y, t ) ), spanWarp( spanWarp ), abortCheck( abortCheck ),
+		maxDisplacement( std::max( 0., maxDisplacement ) ), numOutOfRangePixels( 0 ),
+		numBlockRows( std::max( 1, numBlockRows ) ), nextBlock( 0 ), isCancelled( false )
+{
+	this->displacementEncoding.setMaxDisplacement( this->maxDisplacement );
+	this->encodedDisplacements.resize( size_t( this->r - this->x ) * size_t( this->t - this->y ) * 2 );
+	this->numBlocks = ( this->t - this->y + this->numBlockRows - 1 ) / this->numBlockRows;
+	this->blockStates.reset( new std::atomic<int>[this->numBlocks] );
+	for( int i = 0 ; i < this->numBlocks ; i++ )
+		this->blockStates[i] = BLOCK_PENDING;
+}
+FrameWarpMap::~FrameWarpMap()
+{
+	this->stop();
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	start warping blocks in %numThreads% threads and return
+void FrameWarpMap::start( int numThreads )
+{
+	for( int i = 0 ; i < numThreads ; i++ )
+		this->threads.push_back( std::thread( &FrameWarpMap::warpBlocks, this ) );
+}
+
+//	warp every block in %numThreads% threads, including the calling
+//		one, and return when all of them are done
+//	returns false if aborted before
+bool FrameWarpMap::build( int numThreads )
+{
+	this->start( numThreads - 1 );
+	this->warpBlocks();
+
+	//	the last blocks may still be warped by other threads
+	bool isBuilt = true;
+	for( int i = 0 ; i < this->numBlocks && isBuilt ; i++ )
+		isBuilt = this->warpOrWaitForBlock( i );
+	this->stop();
+	
+	return isBuilt;
+}
+
+//	get source positions of pixels [%x%,%r%) of row %y%, warping or
+//		waiting for its block first. Pixels outside of the box can't be warped
+//	returns false if aborted before, no pixel is warped then
+bool FrameWarpMap::getSourcePixels( int y, int x, int r, Vector2 *sourcePixels_ret, bool *isWarped_ret )
+{
+	if( y < this->y || y >= this->t )
+	{
+		std::fill( isWarped_ret, isWarped_ret + ( r - x ), false );
+		return true;
+	}
+
+	if( !this->warpOrWaitForBlock( ( y - this->y ) / this->numBlockRows ) )
+	{
+		std::fill( isWarped_ret, isWarped_ret + ( r - x ), false );
+		return false;
+	}
+
+	const int16_t *rowDisplacements = &this->encodedDisplacements[size_t( y - this->y ) * size_t( this->r - this->x ) * 2];
+	int numOutOfRangePixels = 0;
+	for( int i = 0 ; i < r - x ; i++ )
+	{
+		int pixelX = x + i;
+		isWarped_ret[i] = pixelX >= this->x && pixelX < this->r;
+		if( !isWarped_ret[i] )
+			continue;
+
+		const int16_t *encoded = rowDisplacements + ( pixelX - this->x ) * 2;
+		if( encoded[0] != INVALID_ENCODED_DISPLACEMENT )
+			sourcePixels_ret[i] = this->displacementEncoding.decode( Vector2( pixelX, y ), encoded );
+		else if( encoded[1] == OUT_OF_RANGE_ENCODED_DISPLACEMENT )
+			numOutOfRangePixels++;
+		else
+			isWarped_ret[i] = false;
+	}
+	if( numOutOfRangePixels == 0 )
+		return true;
+
+	//	warp pixels beyond the maximum displacement again
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	Vector2 *outOfRangePixels = scratchArena.allocate<Vector2>( numOutOfRangePixels );
+	bool *isOutOfRangeWarped = scratchArena.allocate<bool>( numOutOfRangePixels );
+	int *outOfRangeIndices = scratchArena.allocate<int>( numOutOfRangePixels );
+	for( int i = 0, k = 0 ; i < r - x ; i++ )
+	{
+		const int16_t *encoded = rowDisplacements + ( x + i - this->x ) * 2;
+		if( isWarped_ret[i] && encoded[0] == INVALID_ENCODED_DISPLACEMENT )
+		{
+			outOfRangePixels[k] = Vector2( x + i, y );
+			isOutOfRangeWarped[k] = true;
+			outOfRangeIndices[k++] = i;
+		}
+	}
+	this->spanWarp( outOfRangePixels, numOutOfRangePixels, outOfRangePixels, isOutOfRangeWarped );
+	for( int k = 0 ; k < numOutOfRangePixels ; k++ )
+	{
+		sourcePixels_ret[outOfRangeIndices[k]] = outOfRangePixels[k];
+		isWarped_ret[outOfRangeIndices[k]] = isOutOfRangeWarped[k];
+	}
+	
+	return true;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	check if this is cancelled or the render aborted
+bool FrameWarpMap::isAborted() const
+{
+	return this->isCancelled || ( this->abortCheck && this->abortCheck() );
+}
+
+//	claim and warp blocks until there is none left or this is aborted
+void FrameWarpMap::warpBlocks()
+{
+	while( !this->isAborted() )
+	{
+		int block = this->nextBlock++;
+		if( block >= this->numBlocks )
+			return;
+
+		//	a reader may have claimed it first
+		if( this->claimBlock( block ) )
+			this->warpBlock( block );
+	}
+}
+
+//	warp %block% if nobody has claimed it, else wait until it is done
+//	returns false if aborted before
+bool FrameWarpMap::warpOrWaitForBlock( int block )
+{
+	while( this->blockStates[block] != BLOCK_DONE )
+	{
+		if( this->isAborted() )
+			return false;
+
+		if( this->claimBlock( block ) )
+			return this->warpBlock( block );
+
+		//	wait until the block is done or given up ( then it is claimed here ),
+		//		checking for an abort in between
+		std::unique_lock<std::mutex> lock( this->blockMutex );
+		this->blockDone.wait_for( lock, std::chrono::milliseconds( FRAME_WARP_MAP_ABORT_CHECK_MS ), 
+									[this, block]() { return this->blockStates[block] != BLOCK_WARPING; } );
+	}
+
+	return true;
+}
+
+//	claim %block%
+//	returns false if it has been claimed already
+bool FrameWarpMap::claimBlock( int block )
+{
+	int state = BLOCK_PENDING;
+	return this->blockStates[block].compare_exchange_strong( state, BLOCK_WARPING );
+}
+
+//	warp rows of %block% claimed by this thread
+//	returns false if aborted before, the block can be claimed again then
+bool FrameWarpMap::warpBlock( int block )
+{
+	int width = this->r - this->x,
+		blockY = this->y + block * this->numBlockRows,
+		blockT = std::min( blockY + this->numBlockRows, this->t );
+
+	//	all per row buffers come from the scratch arena of this thread
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	Vector2 *sourcePixels = scratchArena.allocate<Vector2>( width );
+	bool *isWarped = scratchArena.allocate<bool>( width );
+	int numOutOfRangePixels = 0;
+	for( int j = blockY ; j < blockT ; j++ )
+	{
+		//	give the block up, rows warped so far are warped ( and counted )
+		//		again by whoever claims it next
+		if( this->isAborted() )
+		{
+			this->setBlockState( block, BLOCK_PENDING );
+			return false;
+		}
+
+		for( int i = 0 ; i < width ; i++ )
+		{
+			sourcePixels[i] = Vector2( this->x + i, j );
+			isWarped[i] = true;
+		}
+		this->spanWarp( sourcePixels, width, sourcePixels, isWarped );
+
+		int16_t *rowDisplacements = &this->encodedDisplacements[size_t( j - this->y ) * width * 2];
+		for( int i = 0 ; i < width ; i++ )
+		{
+			int16_t *encoded = rowDisplacements + i * 2;
+			Vector2 pixel( this->x + i, j );
+			if( !isWarped[i] )
+				encoded[0] = encoded[1] = INVALID_ENCODED_DISPLACEMENT;
+			else if( fabs( sourcePixels[i].x - pixel.x ) > this->maxDisplacement || 
+					fabs( sourcePixels[i].y - pixel.y ) > this->maxDisplacement )
+			{
+				encoded[0] = INVALID_ENCODED_DISPLACEMENT;
+				encoded[1] = OUT_OF_RANGE_ENCODED_DISPLACEMENT;
+				numOutOfRangePixels++;
+			}
+			else
+				this->displacementEncoding.encode( pixel, sourcePixels[i], encoded );
+		}
+	}
+	this->numOutOfRangePixels += numOutOfRangePixels;
+	this->setBlockState( block, BLOCK_DONE );
+	
+	return true;
+}
+
+//	set state of %block% claimed by this thread and wake readers waiting on it
+void FrameWarpMap::setBlockState( int block, int state )
+{
+	//	the state is changed under the lock so a waiting reader can't miss it
+	{
+		std::lock_guard<std::mutex> lock( this->blockMutex );
+		this->blockStates[block] = state;
+	}
+	this->blockDone.notify_all();
+}
+
+//	stop and join all threads
+void FrameWarpMap::stop()
+{
+	this->isCancelled = true;
+	for( size_t i = 0 ; i < this->threads.size() ; i++ )
+		this->threads[i].join();
+	this->threads.clear();
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS FrameWarpMap MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
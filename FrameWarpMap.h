@@ -0,0 +1,255 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___FrameWarpMap_h)
+#define ___FrameWarpMap_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//	fixed point displacements
+#include "DisplacementEncoding.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	default number of rows of a block, the unit of work of the threads
+#define DEFAULT_FRAME_WARP_MAP_BLOCK_ROWS 16
+
+//	second encoded displacement component of a pixel whose displacement
+//		is beyond the maximum ( the first one is INVALID_ENCODED_DISPLACEMENT ),
+//		it is warped again when read
+#define OUT_OF_RANGE_ENCODED_DISPLACEMENT 0
+
+//	time ( in millisecond ) between abort checks of a reader waiting
+//		for a block warped by another thread
+#define FRAME_WARP_MAP_ABORT_CHECK_MS 20
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class FrameWarpMap
+//
+//---------------------------------------------------------------------
+
+//	source position of every pixel of a box, warped by blocks of rows in
+//		parallel. Threads take the next block nobody has claimed, and a
+//		reader of a row which isn't warped yet warps its block itself or
+//		waits for the thread warping it, never for the whole box. Positions
+//		are stored as DisplacementEncoding displacements from their pixel with
+//		a scale chosen up front from the expected maximum displacement, the
+//		few pixels beyond it are warped again when read. Once aborted, threads
+//		stop after the row they are warping and leave its block to be warped
+//		again, and readers return without the positions
+class FrameWarpMap
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+		//	warp of %numPixels% output positions %outputPixels% to their source
+		//		positions, with the span conventions of the node: on entry a false
+		//		in %isWarped_ret% skips that position, on return it tells whether
+		//		the position is warped
+		typedef std::function<void( const Vector2 *outputPixels, int numPixels,
+									Vector2 *sourcePixels_ret, bool *isWarped_ret )> SpanWarp;
+
+		//	check if the render the positions are warped for is aborted
+		typedef std::function<bool()> AbortCheck;
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//	box of the positions, [x,r) x [y,t)
+		int x, y, r, t;
+
+		//	warp of the positions, and check of the render being aborted
+		//		( never aborted when empty )
+		SpanWarp spanWarp;
+		AbortCheck abortCheck;
+
+		//	encoding of the displacement ( in pixel ) of every pixel to its
+		//		source position, two values per pixel in rows from the bottom,
+		//		both INVALID_ENCODED_DISPLACEMENT for a pixel that can't be warped
+		//		and INVALID_ENCODED_DISPLACEMENT then OUT_OF_RANGE_ENCODED_DISPLACEMENT
+		//		for a pixel beyond the maximum displacement
+		DisplacementEncoding displacementEncoding;
+		std::vector<int16_t> encodedDisplacements;
+		
+		//	largest displacement encoded along x or y ( in pixel ), and number
+		//		of pixels warped beyond it
+		double maxDisplacement;
+		std::atomic<int> numOutOfRangePixels;
+
+		//	number of rows of a block and number of blocks
+		int numBlockRows, numBlocks;
+
+		//	state of every block ( BLOCK_PENDING, BLOCK_WARPING, BLOCK_DONE )
+		std::unique_ptr<std::atomic<int>[]> blockStates;
+
+		//	next block for the threads to claim, and whether they stop
+		//		claiming blocks
+		std::atomic<int> nextBlock;
+		std::atomic<bool> isCancelled;
+
+		//	guard and signal of a block done or given up, for readers waiting on it
+		std::mutex blockMutex;
+		std::condition_variable blockDone;
+
+		//	threads warping blocks
+		std::vector<std::thread> threads;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		//	%maxDisplacement% is the largest displacement ( in pixel ) along
+		//		x or y expected, it sets the encoding error
+		FrameWarpMap( int x, int y, int r, int t, double maxDisplacement, const SpanWarp &spanWarp,
+						const AbortCheck &abortCheck = AbortCheck(),
+						int numBlockRows = DEFAULT_FRAME_WARP_MAP_BLOCK_ROWS );
+
+		//	threads are stopped after the row they are warping
+		~FrameWarpMap();
+
+	private:
+		//	not copyable, threads refer to it
+		FrameWarpMap( const FrameWarpMap & );
+		FrameWarpMap &operator=( const FrameWarpMap & );
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get encoded displacements of every pixel and their encoding ( see
+		//		this->encodedDisplacements ), they are complete once this->build
+		//		has returned
+		const int16_t *getEncodedDisplacements() const
+		{	return this->encodedDisplacements.data();	}
+		const DisplacementEncoding &getDisplacementEncoding() const
+		{	return this->displacementEncoding;	}
+		
+		//	get largest error of a source position read ( in pixel )
+		double getMaxError() const
+		{	return this->displacementEncoding.getMaxError();	}
+		
+		//	get number of pixels warped so far whose displacement is beyond
+		//		the maximum, and so isn't encoded
+		int getNumOutOfRangePixels() const
+		{	return this->numOutOfRangePixels;	}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	start warping blocks in %numThreads% threads and return
+		void start( int numThreads );
+
+		//	warp every block in %numThreads% threads, including the calling
+		//		one, and return when all of them are done
+		//	returns false if aborted before
+		bool build( int numThreads );
+
+		//	get source positions of pixels [%x%,%r%) of row %y%, warping or
+		//		waiting for its block first. Pixels outside of the box can't be warped
+		//	returns false if aborted before, no pixel is warped then
+		bool getSourcePixels( int y, int x, int r, Vector2 *sourcePixels_ret, bool *isWarped_ret );
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+		//	check if this is cancelled or the render aborted
+		bool isAborted() const;
+
+		//	claim and warp blocks until there is none left or this is aborted
+		void warpBlocks();
+
+		//	warp %block% if nobody has claimed it, else wait until it is done
+		//	returns false if aborted before
+		bool warpOrWaitForBlock( int block );
+
+		//	claim %block%
+		//	returns false if it has been claimed already
+		bool claimBlock( int block );
+
+		//	warp rows of %block% claimed by this thread
+		//	returns false if aborted before, the block can be claimed again then
+		bool warpBlock( int block );
+
+		//	set state of %block% claimed by this thread and wake readers waiting on it
+		void setBlockState( int block, int state );
+
+		//	stop and join all threads
+		void stop();
+
+};
+//---------------------------------------------------------------------
+//	END class FrameWarpMap
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <cmath>
+#include <algorithm>
 
 //---------------------------------------------------------------------
 //
@@ -30,6 +31,81 @@
 //	maximum number of iterations for numerical solutions
 #define MAX_NUM_ITERATIONS 100
 
+//	maximum number of times the bracket of the 1D root find is doubled
+#define MAX_NUM_BRACKET_EXPANSIONS 32
+
+//---------------------------------------------------------------------
+//	span lane functions
+
+//	parabolic fits of warp offsets copied out of the engine so the lane
+//		loops below work on local values only
+class LaneWarpFits
+{
+	public:
+		ParabolicFit topX, topY, bottomX, bottomY;
+		
+	public:
+		LaneWarpFits( const RollingShutterLensDistortionEngine &lensDistortionEngine ) :
+				topX( lensDistortionEngine.getTopOffsetFitX() ),
+				topY( lensDistortionEngine.getTopOffsetFitY() ),
+				bottomX( lensDistortionEngine.getBottomOffsetFitX() ),
+				bottomY( lensDistortionEngine.getBottomOffsetFitY() )
+		{
+		}
+};
+
+//	compute warp offset in [0,1] ( applyRollingShutterWarp( p ) - p ) of every lane
+static inline void computeLaneWarpOffsets( const LaneWarpFits &fits, 
+											const double *px, const double *py, 
+											double *offsetX_ret, double *offsetY_ret )
+{
+	for( int i = 0 ; i < INVERT_WARP_SPAN_NUM_LANES ; i++ )
+	{
+		double ndcX = 2 * px[i] - 1,
+				ndcY = 2 * py[i] - 1;
+		double topWeight = ( ndcY * ndcY + ndcY ) / 4,
+				bottomWeight = ( ndcY * ndcY - ndcY ) / 4;
+		offsetX_ret[i] = ( ( fits.topX.a * ndcX + fits.topX.b ) * ndcX + fits.topX.c ) * topWeight + 
+							( ( fits.bottomX.a * ndcX + fits.bottomX.b ) * ndcX + fits.bottomX.c ) * bottomWeight;
+		offsetY_ret[i] = ( ( fits.topY.a * ndcX + fits.topY.b ) * ndcX + fits.topY.c ) * topWeight + 
+							( ( fits.bottomY.a * ndcX + fits.bottomY.b ) * ndcX + fits.bottomY.c ) * bottomWeight;
+	}
+}
+
+//	compute newton step ( J^-1 * error ) of every lane from analytic partial 
+//		derivatives, same as RollingShutterLensDistortionEngine::computeWarpJacobian
+static inline void computeLaneNewtonSteps( const LaneWarpFits &fits, 
+											const double *px, const double *py, 
+											const double *errorX, const double *errorY, 
+											double *stepX_ret, double *stepY_ret )
+{
+	for( int i = 0 ; i < INVERT_WARP_SPAN_NUM_LANES ; i++ )
+	{
+		double ndcX = 2 * px[i] - 1,
+				ndcY = 2 * py[i] - 1;
+		double topWeight = ( ndcY * ndcY + ndcY ) / 2,
+				bottomWeight = ( ndcY * ndcY - ndcY ) / 2,
+				topWeightDy = ndcY + 0.5,
+				bottomWeightDy = ndcY - 0.5;
+		
+		//	partial derivatives along x ( U ) and y ( V )
+		double ux = 1 + ( 2 * fits.topX.a * ndcX + fits.topX.b ) * topWeight + 
+						( 2 * fits.bottomX.a * ndcX + fits.bottomX.b ) * bottomWeight,
+				uy = ( 2 * fits.topY.a * ndcX + fits.topY.b ) * topWeight + 
+						( 2 * fits.bottomY.a * ndcX + fits.bottomY.b ) * bottomWeight,
+				vx = ( ( fits.topX.a * ndcX + fits.topX.b ) * ndcX + fits.topX.c ) * topWeightDy + 
+						( ( fits.bottomX.a * ndcX + fits.bottomX.b ) * ndcX + fits.bottomX.c ) * bottomWeightDy,
+				vy = 1 + ( ( fits.topY.a * ndcX + fits.topY.b ) * ndcX + fits.topY.c ) * topWeightDy + 
+						( ( fits.bottomY.a * ndcX + fits.bottomY.b ) * ndcX + fits.bottomY.c ) * bottomWeightDy;
+		
+		//	solve a*U + b*V = error by cramer's rule, a singular
+		//		jacobian gives a non finite step which never improves
+		double inverseDeterminant = 1 / ( ux * vy - vx * uy );
+		stepX_ret[i] = ( errorX[i] * vy - vx * errorY[i] ) * inverseDeterminant;
+		stepY_ret[i] = ( ux * errorY[i] - errorX[i] * uy ) * inverseDeterminant;
+	}
+}
+
 //---------------------------------------------------------------------
 //	GLOBALS
 //---------------------------------------------------------------------
@@ -88,12 +164,18 @@
 //		this numerical method will not be able to invert it above the vertex.
 //		Therefore, in Nuke lens distortion when r^4 is negative and r is high, you cannot remove warp. 
 //		Normally this is not a problem because it typically happens in the overscan area only where r is very high.
+//	If %stats_ret% is given it is filled in even when throwing.
 Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &lensDistortionEngine,
 											const Vector2 &initialRemoveWarpGuessQ,
 											const Vector2 &q,
-											double numericalError /*= DEFAULT_NUMERICAL_ERROR*/ ) 
+											double numericalError /*= DEFAULT_NUMERICAL_ERROR*/,
+											InvertWarpStats *stats_ret /*= NULL*/ ) 
 									throw( ynxValueException )
 {
+	//	collect statistics locally when not asked for
+	InvertWarpStats localStats;
+	InvertWarpStats *stats = stats_ret ? stats_ret : &localStats;
+	*stats = InvertWarpStats();
 	
 	//	compute sqr of epsilon
 	double epsilon = numericalError;
@@ -103,11 +185,12 @@ Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &l
 	Vector2 unwarpedQ( initialRemoveWarpGuessQ );
 			
 	//	compute error
-	Vector2 warpedUnwarpedQ( lensDistortionEngine.applyWarp( unwarpedQ ) );
+	Vector2 warpedUnwarpedQ( lensDistortionEngine.applyRollingShutterWarp( unwarpedQ ) );
 	Vector2 errorV( warpedUnwarpedQ - q );
 				
 	//	compute square of error
 	double sqrError = errorV.sqrnorm();
+	stats->initialSqrError = stats->finalSqrError = sqrError;
 							
 	//	keep looping until the error is less than epsilon
 	int iterCount = 0;
@@ -117,19 +200,19 @@ Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &l
 		//		warped pixel when moving in pure x or y
 		Vector2 unwarpedQ_dx( unwarpedQ );
 		unwarpedQ_dx.x += epsilon;
-		Vector2 partialX( lensDistortionEngine.applyWarp( unwarpedQ_dx ) - warpedUnwarpedQ );
+		Vector2 partialX( lensDistortionEngine.applyRollingShutterWarp( unwarpedQ_dx ) - warpedUnwarpedQ );
 		partialX /= epsilon;
 		
 		Vector2 unwarpedQ_dy( unwarpedQ );
 		unwarpedQ_dy.y += epsilon;
-		Vector2 partialY( lensDistortionEngine.applyWarp( unwarpedQ_dy ) - warpedUnwarpedQ );
+		Vector2 partialY( lensDistortionEngine.applyRollingShutterWarp( unwarpedQ_dy ) - warpedUnwarpedQ );
 		partialY /= epsilon;
 
 		//	compute (a,b) such that a*partialX+b*partialY
 		//		equals %error%
 		//	This becomes the solution for how much to offset
 		//		unwarpedQ to exactly hit target %q% if
-		//		this->applyWarp() were exactly a linear
+		//		this->applyRollingShutterWarp() were exactly a linear
 		//		function in 2D
 		const Vector2 &U = partialX,
 					&V = partialY,
@@ -183,9 +266,12 @@ Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &l
 			stepScalar /= 2;
 			
 			//	compute new error
+			if( stepScalar < 0.5 )
+				stats->numStepHalvings ++;
+			
 			try
 			{ 
-				improvedWarpedUnwarpedQ = lensDistortionEngine.applyWarp( improvedUnwarpedQ ); 
+				improvedWarpedUnwarpedQ = lensDistortionEngine.applyRollingShutterWarp( improvedUnwarpedQ ); 
 				improvedErrorV = improvedWarpedUnwarpedQ - q;
 				improvedSqrError = improvedErrorV.sqrnorm();
 
@@ -213,13 +299,292 @@ Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &l
 		
 		//	increment iterCount
 		iterCount ++;
+		stats->numIterations = iterCount;
+		stats->finalSqrError = sqrError;
 		if( iterCount > MAX_NUM_ITERATIONS )
 			throw ynxValueException( "LensDistortionWarp::removeWarp() : iterCount exceeds numerical maximum! Giving up!" );
 	}
 	
 	//	return
+	stats->isConverged = true;
 	return unwarpedQ;
 }
+
+//	numerically invert this->applyWarp for %numPoints% points of %q% at once,
+//		INVERT_WARP_SPAN_NUM_LANES points are solved together by damped
+//		newton with analytic partial derivatives, converged or failed lanes
+//		are masked off while the others keep iterating.
+//	On entry a false in %isSolved_ret% skips that point ( %p_ret% is left
+//		untouched ), on return it tells whether the point is solved ( no 
+//		exception is thrown ).
+//	If %statistics% is given every solved or failed point is added to it.
+//	If %initialGuesses% is given the solve starts there instead of at
+//		RollingShutterLensDistortionEngine::predictRemoveRollingShutterWarp.
+void InvertWarpFuncs::removeWarpSpan( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											const Vector2 *q,
+											int numPoints,
+											Vector2 *p_ret,
+											bool *isSolved_ret,
+											double numericalError /*= DEFAULT_NUMERICAL_ERROR*/,
+											InvertWarpStatistics *statistics /*= NULL*/,
+											const Vector2 *initialGuesses /*= NULL*/ )
+{
+	const int NUM_LANES = INVERT_WARP_SPAN_NUM_LANES;
+	
+	//	compute sqr of epsilon
+	double epsilon = numericalError;
+	double epsilonSqr = epsilon * epsilon;
+	
+	//	copy fits once for all lanes
+	LaneWarpFits fits( lensDistortionEngine );
+	
+	//	lane state
+	double qx[NUM_LANES], qy[NUM_LANES],
+			px[NUM_LANES], py[NUM_LANES],
+			offsetX[NUM_LANES], offsetY[NUM_LANES],
+			errorX[NUM_LANES], errorY[NUM_LANES], sqrError[NUM_LANES],
+			newtonX[NUM_LANES], newtonY[NUM_LANES],
+			stepX[NUM_LANES], stepY[NUM_LANES], stepScalar[NUM_LANES],
+			tryX[NUM_LANES], tryY[NUM_LANES],
+			initialSqrError[NUM_LANES];
+	int numIterations[NUM_LANES], numStepHalvings[NUM_LANES];
+	bool isActive[NUM_LANES], isConverged[NUM_LANES];
+	
+	for( int start = 0 ; start < numPoints ; start += NUM_LANES )
+	{
+		//	load lanes, lanes past the end or skipped are inactive
+		int numLanes = std::min( NUM_LANES, numPoints - start );
+		for( int i = 0 ; i < NUM_LANES ; i++ )
+		{
+			int index = start + std::min( i, numLanes - 1 );
+			qx[i] = q[index].x;
+			qy[i] = q[index].y;
+			isActive[i] = i < numLanes && isSolved_ret[index];
+		}
+		
+		if( initialGuesses != NULL )
+		{
+			//	given initial guess
+			for( int i = 0 ; i < NUM_LANES ; i++ )
+			{
+				int index = start + std::min( i, numLanes - 1 );
+				px[i] = initialGuesses[index].x;
+				py[i] = initialGuesses[index].y;
+			}
+		}
+		else
+		{
+			//	initial guess by the same two fixed point steps as
+			//		RollingShutterLensDistortionEngine::predictRemoveRollingShutterWarp
+			computeLaneWarpOffsets( fits, qx, qy, offsetX, offsetY );
+			for( int i = 0 ; i < NUM_LANES ; i++ )
+			{
+				px[i] = qx[i] - offsetX[i];
+				py[i] = qy[i] - offsetY[i];
+			}
+			computeLaneWarpOffsets( fits, px, py, offsetX, offsetY );
+			for( int i = 0 ; i < NUM_LANES ; i++ )
+			{
+				px[i] = qx[i] - offsetX[i];
+				py[i] = qy[i] - offsetY[i];
+			}
+		}
+		
+		//	compute error of initial guess
+		computeLaneWarpOffsets( fits, px, py, offsetX, offsetY );
+		bool isAnyActive = false;
+		for( int i = 0 ; i < NUM_LANES ; i++ )
+		{
+			errorX[i] = px[i] + offsetX[i] - qx[i];
+			errorY[i] = py[i] + offsetY[i] - qy[i];
+			sqrError[i] = initialSqrError[i] = errorX[i] * errorX[i] + errorY[i] * errorY[i];
+			stepScalar[i] = 1;
+			numIterations[i] = numStepHalvings[i] = 0;
+			isConverged[i] = isActive[i] && sqrError[i] <= epsilonSqr;
+			isActive[i] = isActive[i] && !isConverged[i];
+			isAnyActive |= isActive[i];
+		}
+		
+		//	every pass takes a new newton step in lanes which just improved,
+		//		or halves the step in lanes which didn't, until all lanes
+		//		converged or failed
+		while( isAnyActive )
+		{
+			//	take a new newton step only where the step isn't being halved
+			computeLaneNewtonSteps( fits, px, py, errorX, errorY, newtonX, newtonY );
+			for( int i = 0 ; i < NUM_LANES ; i++ )
+			{
+				bool isNewStep = stepScalar[i] == 1;
+				stepX[i] = isNewStep ? newtonX[i] : stepX[i];
+				stepY[i] = isNewStep ? newtonY[i] : stepY[i];
+				tryX[i] = px[i] - stepX[i] * stepScalar[i];
+				tryY[i] = py[i] - stepY[i] * stepScalar[i];
+			}
+			
+			//	compute new error and keep it where it improved
+			computeLaneWarpOffsets( fits, tryX, tryY, offsetX, offsetY );
+			isAnyActive = false;
+			for( int i = 0 ; i < NUM_LANES ; i++ )
+			{
+				double tryErrorX = tryX[i] + offsetX[i] - qx[i],
+						tryErrorY = tryY[i] + offsetY[i] - qy[i];
+				double trySqrError = tryErrorX * tryErrorX + tryErrorY * tryErrorY;
+				
+				//	a non finite error compares false, so it is treated as "worse"
+				bool isImproved = isActive[i] && trySqrError < sqrError[i];
+				bool isWorse = isActive[i] && !isImproved;
+				
+				//	update current best guess
+				px[i] = isImproved ? tryX[i] : px[i];
+				py[i] = isImproved ? tryY[i] : py[i];
+				errorX[i] = isImproved ? tryErrorX : errorX[i];
+				errorY[i] = isImproved ? tryErrorY : errorY[i];
+				sqrError[i] = isImproved ? trySqrError : sqrError[i];
+				numIterations[i] += isImproved;
+				numStepHalvings[i] += isWorse;
+				stepScalar[i] = isImproved ? 1 : stepScalar[i] / 2;
+				
+				//	converged, or must give up on tiny step scalar or too many iterations
+				isConverged[i] = isConverged[i] || ( isImproved && sqrError[i] <= epsilonSqr );
+				bool isFailed = ( isWorse && stepScalar[i] < epsilon ) || numIterations[i] > MAX_NUM_ITERATIONS;
+				isActive[i] = isActive[i] && !isConverged[i] && !isFailed;
+				isAnyActive |= isActive[i];
+			}
+		}
+		
+		//	store lanes, skipped points are left untouched
+		for( int i = 0 ; i < numLanes ; i++ )
+		{
+			int index = start + i;
+			if( !isSolved_ret[index] )
+				continue;
+			
+			//	add statistics of solved or failed points
+			if( statistics != NULL )
+			{
+				InvertWarpStats stats;
+				stats.numIterations = numIterations[i];
+				stats.numStepHalvings = numStepHalvings[i];
+				stats.initialSqrError = initialSqrError[i];
+				stats.finalSqrError = sqrError[i];
+				stats.isConverged = isConverged[i];
+				statistics->add( stats );
+			}
+			
+			p_ret[index] = Vector2( px[i], py[i] );
+			isSolved_ret[index] = isConverged[i];
+		}
+	}
+}
+
+//	invert this->applyWarp by reducing it to a 1D root find. For a
+//		candidate source y every term of the warp is a quadratic in x, so
+//		the source x is solved in closed form, leaving a scalar residual
+//		in y which is bracketed around %initialRemoveWarpGuessQ% and then
+//		refined by the illinois ( modified regula falsi ) method.
+//	THROWS ynxValueException when no bracket is found ( e.g. folded warp )
+//	If %stats_ret% is given it is filled in even when throwing,
+//		numStepHalvings counts bracket expansions.
+Vector2 InvertWarpFuncs::removeWarpBracketed( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											const Vector2 &initialRemoveWarpGuessQ,
+											const Vector2 &q,
+											double numericalError /*= DEFAULT_NUMERICAL_ERROR*/,
+											InvertWarpStats *stats_ret /*= NULL*/ ) 
+									throw( ynxValueException )
+{
+	//	collect statistics locally when not asked for
+	InvertWarpStats localStats;
+	InvertWarpStats *stats = stats_ret ? stats_ret : &localStats;
+	*stats = InvertWarpStats();
+	
+	//	work in NDC, where the error is twice the error in [0,1]
+	double ndcX = 2 * q.x - 1,
+			ndcTargetY = 2 * q.y - 1;
+	double epsilon = 2 * numericalError;
+	
+	//	residual at the initial guess
+	double y0 = 2 * initialRemoveWarpGuessQ.y - 1;
+	double x0, g0;
+	if( !computeBracketedResidual( lensDistortionEngine, ndcX, ndcTargetY, y0, &x0, &g0 ) )
+		throw ynxValueException( "InvertWarpFuncs::removeWarpBracketed() : initial guess is folded! Giving up!" );
+	stats->initialSqrError = stats->finalSqrError = g0 * g0 / 4;
+	
+	//	initial guess already good enough
+	if( fabs( g0 ) <= epsilon )
+	{
+		stats->isConverged = true;
+		return Vector2( ( x0 + 1 ) / 2, ( y0 + 1 ) / 2 );
+	}
+	
+	//	the residual grows with y ( it is y plus a small offset ), so
+	//		search for a sign change in the direction of -g0, doubling
+	//		the step each time
+	double step = fabs( g0 ) * ( g0 > 0 ? -1 : 1 );
+	double y1 = y0, x1 = x0, g1 = g0;
+	int numExpansions = 0;
+	for( ; ; )
+	{
+		//	shift bracket
+		y0 = y1;
+		x0 = x1;
+		g0 = g1;
+		
+		y1 = y0 + step;
+		if( !computeBracketedResidual( lensDistortionEngine, ndcX, ndcTargetY, y1, &x1, &g1 ) )
+			throw ynxValueException( "InvertWarpFuncs::removeWarpBracketed() : bracket runs into a fold! Giving up!" );
+		
+		//	found sign change
+		if( ( g0 < 0 ) != ( g1 < 0 ) )
+			break;
+		
+		step *= 2;
+		stats->numStepHalvings = ++ numExpansions;
+		if( numExpansions > MAX_NUM_BRACKET_EXPANSIONS )
+			throw ynxValueException( "InvertWarpFuncs::removeWarpBracketed() : no bracket found! Giving up!" );
+	}
+	
+	//	illinois iterations on [y0, y1]
+	int iterCount = 0;
+	int lastSide = 0;
+	double y = y1, x = x1, g = g1;
+	while( fabs( g ) > epsilon )
+	{
+		//	secant through bracket ends
+		y = y1 - g1 * ( y1 - y0 ) / ( g1 - g0 );
+		if( !computeBracketedResidual( lensDistortionEngine, ndcX, ndcTargetY, y, &x, &g ) )
+			throw ynxValueException( "InvertWarpFuncs::removeWarpBracketed() : folded inside bracket! Giving up!" );
+		
+		//	replace the end with the same sign, and halve the residual of
+		//		an end which is kept twice in a row
+		if( ( g < 0 ) == ( g1 < 0 ) )
+		{
+			y1 = y;
+			g1 = g;
+			if( lastSide == 1 )
+				g0 /= 2;
+			lastSide = 1;
+		}
+		else
+		{
+			y0 = y;
+			g0 = g;
+			if( lastSide == -1 )
+				g1 /= 2;
+			lastSide = -1;
+		}
+		
+		//	increment iterCount
+		iterCount ++;
+		stats->numIterations = iterCount;
+		stats->finalSqrError = g * g / 4;
+		if( iterCount > MAX_NUM_ITERATIONS )
+			throw ynxValueException( "InvertWarpFuncs::removeWarpBracketed() : iterCount exceeds numerical maximum! Giving up!" );
+	}
+	
+	//	return
+	stats->isConverged = true;
+	return Vector2( ( x + 1 ) / 2, ( y + 1 ) / 2 );
+}
 	//---------------------------------------------------------------------
 	//	public operator overloads
 	//---------------------------------------------------------------------
@@ -228,6 +593,44 @@ Vector2 InvertWarpFuncs::removeWarp( const RollingShutterLensDistortionEngine &l
 	//	protected member functions
 	//---------------------------------------------------------------------
 
+//	for source y %ndcY% solve the source x which warps to %ndcX%
+//		and compute residual of warped y against %ndcTargetY%, all in NDC.
+//		Return false if there is no such x ( fold along x )
+bool InvertWarpFuncs::computeBracketedResidual( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											double ndcX,
+											double ndcTargetY,
+											double ndcY,
+											double *ndcSourceX_ret,
+											double *residual_ret )
+{
+	//	weights of top and bottom offsets of the vertical parabola
+	double topWeight = ( ndcY * ndcY + ndcY ) / 2,
+			bottomWeight = ( ndcY * ndcY - ndcY ) / 2;
+	
+	//	x offset along this row is A*x^2 + B*x + C
+	const ParabolicFit &topFitX = lensDistortionEngine.getTopOffsetFitX(),
+						&bottomFitX = lensDistortionEngine.getBottomOffsetFitX();
+	double A = topFitX.a * topWeight + bottomFitX.a * bottomWeight,
+			B = topFitX.b * topWeight + bottomFitX.b * bottomWeight,
+			C = topFitX.c * topWeight + bottomFitX.c * bottomWeight;
+	
+	//	solve A*x^2 + (1+B)*x + (C-ndcX) = 0 for the root which tends to
+	//		the linear solution as A goes to zero ( stable form )
+	double linear = 1 + B;
+	double discriminant = linear * linear - 4 * A * ( C - ndcX );
+	if( linear <= 0 || discriminant < 0 )
+		return false;
+	double x = 2 * ( ndcX - C ) / ( linear + sqrt( discriminant ) );
+	
+	//	warped y at (x, ndcY)
+	double offsetY = lensDistortionEngine.getTopOffsetFitY().f( x ) * topWeight + 
+						lensDistortionEngine.getBottomOffsetFitY().f( x ) * bottomWeight;
+	
+	*ndcSourceX_ret = x;
+	*residual_ret = ndcY + offsetY - ndcTargetY;
+	return true;
+}
+
 //---------------------------------------------------------------------
 //
 //	END CLASS InvertWarpFuncs MEMBER FUNCTIONS
@@ -14,6 +14,7 @@
 //
 //---------------------------------------------------------------------
 
+#include <atomic>
 
 //---------------------------------------------------------------------
 //
@@ -40,6 +41,10 @@
 //	acceptable pixel error when doing numerical inverses
 #define DEFAULT_NUMERICAL_ERROR 1e-7
 
+//	number of points solved together by InvertWarpFuncs::removeWarpSpan,
+//		each lane loop runs this many times so the compiler can vectorize it
+#define INVERT_WARP_SPAN_NUM_LANES 8
+
 //---------------------------------------------------------------------
 //
 //	INLINES
@@ -52,11 +57,96 @@
 //
 //---------------------------------------------------------------------
 
+//---------------------------------------------------------------------
+//
+//	class InvertWarpStats
+//
+//---------------------------------------------------------------------
+
+//	statistics of a single numerical inverse
+class InvertWarpStats
+{
+	public:
+		//	number of improving steps taken and number of times a step
+		//		was halved because it did not improve the error
+		int numIterations, numStepHalvings;
+		
+		//	square of the error at the initial guess and at the end
+		double initialSqrError, finalSqrError;
+		
+		//	is solved to within the numerical error
+		bool isConverged;
+		
+	public:
+		//contructors/destructors
+		InvertWarpStats() : numIterations( 0 ), numStepHalvings( 0 ), 
+							initialSqrError( 0 ), finalSqrError( 0 ), 
+							isConverged( false )
+		{
+		}
+};
+//---------------------------------------------------------------------
+//	END class InvertWarpStats
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class InvertWarpStatistics
+//
+//---------------------------------------------------------------------
+
+//	statistics accumulated over many numerical inverses, may be
+//		shared by all threads
+class InvertWarpStatistics
+{
+	public:
+		//	number of solves, solves where the initial guess was already
+		//		within the numerical error, and failed solves
+		std::atomic<long> numSolves, numInitialGuessAccepted, numFailures;
+		
+		//	total number of iterations and step halvings
+		std::atomic<long> numIterations, numStepHalvings;
+		
+	public:
+		//contructors/destructors
+		InvertWarpStatistics()
+		{
+			this->reset();
+		}
+		
+	public:
+		//	reset all counts to zero
+		void reset()
+		{
+			this->numSolves = this->numInitialGuessAccepted = this->numFailures = 0;
+			this->numIterations = this->numStepHalvings = 0;
+		}
+		
+		//	add statistics of a single solve
+		void add( const InvertWarpStats &stats )
+		{
+			this->numSolves ++;
+			if( stats.isConverged && stats.numIterations == 0 )
+				this->numInitialGuessAccepted ++;
+			if( !stats.isConverged )
+				this->numFailures ++;
+			this->numIterations += stats.numIterations;
+			this->numStepHalvings += stats.numStepHalvings;
+		}
+};
+//---------------------------------------------------------------------
+//	END class InvertWarpStatistics
+//---------------------------------------------------------------------
+
 //---------------------------------------------------------------------
 //
 //	class InvertWarpFuncs
 //
 //---------------------------------------------------------------------
+
+//	numerical inverses of the rolling shutter stage of the engine
+//		( RollingShutterLensDistortionEngine::applyRollingShutterWarp ), the
+//		engine removes its lens distortion stage separately
 class InvertWarpFuncs
 {
 	//---------------------------------------------------------------------
@@ -104,10 +194,46 @@ class InvertWarpFuncs
 		//		this numerical method will not be able to invert it above the vertex.
 		//		Therefore, in Nuke lens distortion when r^4 is negative and r is high, you cannot remove warp. 
 		//		Normally this is not a problem because it typically happens in the overscan area only where r is very high.
+		//	If %stats_ret% is given it is filled in even when throwing.
 		static Vector2 removeWarp( const RollingShutterLensDistortionEngine &lensDistortionEngine,
 											const Vector2 &initialRemoveWarpGuessQ,
 											const Vector2 &q,
-											double numericalError = DEFAULT_NUMERICAL_ERROR ) 
+											double numericalError = DEFAULT_NUMERICAL_ERROR,
+											InvertWarpStats *stats_ret = NULL ) 
+								throw( ynxValueException );
+		
+		//	numerically invert this->applyWarp for %numPoints% points of %q% at once,
+		//		INVERT_WARP_SPAN_NUM_LANES points are solved together by damped
+		//		newton with analytic partial derivatives, converged or failed lanes
+		//		are masked off while the others keep iterating.
+		//	On entry a false in %isSolved_ret% skips that point ( %p_ret% is left
+		//		untouched ), on return it tells whether the point is solved ( no 
+		//		exception is thrown ).
+		//	If %statistics% is given every solved or failed point is added to it.
+		//	If %initialGuesses% is given the solve starts there instead of at
+		//		RollingShutterLensDistortionEngine::predictRemoveRollingShutterWarp.
+		static void removeWarpSpan( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											const Vector2 *q,
+											int numPoints,
+											Vector2 *p_ret,
+											bool *isSolved_ret,
+											double numericalError = DEFAULT_NUMERICAL_ERROR,
+											InvertWarpStatistics *statistics = NULL,
+											const Vector2 *initialGuesses = NULL );
+		
+		//	invert this->applyWarp by reducing it to a 1D root find. For a
+		//		candidate source y every term of the warp is a quadratic in x, so
+		//		the source x is solved in closed form, leaving a scalar residual
+		//		in y which is bracketed around %initialRemoveWarpGuessQ% and then
+		//		refined by the illinois ( modified regula falsi ) method.
+		//	THROWS ynxValueException when no bracket is found ( e.g. folded warp )
+		//	If %stats_ret% is given it is filled in even when throwing,
+		//		numStepHalvings counts bracket expansions.
+		static Vector2 removeWarpBracketed( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											const Vector2 &initialRemoveWarpGuessQ,
+											const Vector2 &q,
+											double numericalError = DEFAULT_NUMERICAL_ERROR,
+											InvertWarpStats *stats_ret = NULL ) 
 								throw( ynxValueException );
 
 	//---------------------------------------------------------------------
@@ -120,6 +246,16 @@ class InvertWarpFuncs
 	//---------------------------------------------------------------------
 	protected:
 	
+		//	for source y %ndcY% solve the source x which warps to %ndcX%
+		//		and compute residual of warped y against %ndcTargetY%, all in NDC.
+		//		Return false if there is no such x ( fold along x )
+		static bool computeBracketedResidual( const RollingShutterLensDistortionEngine &lensDistortionEngine,
+											double ndcX,
+											double ndcTargetY,
+											double ndcY,
+											double *ndcSourceX_ret,
+											double *residual_ret );
+	
 };
 //---------------------------------------------------------------------
 //	END class InvertWarpFuncs
@@ -0,0 +1,250 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "InvertibilityDomain.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	number of samples per axis when measuring displacement and
+//		looking for fold lines
+#define NUM_DISPLACEMENT_SAMPLES 17
+#define NUM_FOLD_SAMPLES 33
+
+//	number of positions probed along a row to find its outermost invertible ones
+#define NUM_ROW_SEED_SAMPLES 16
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS InvertibilityDomain MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS InvertibilityDomain STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS InvertibilityDomain MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+InvertibilityDomain::InvertibilityDomain() : isEverywhereInvertible( true ), firstRowY( 0 ), rowSpacing( 1 )
+{
+	
+}
+InvertibilityDomain::~InvertibilityDomain()
+{
+	
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	compute domain of %engine% over x in [%xMin%,%xMax%] for %numRows% rows at
+//		y = %firstRowY% + i * %rowSpacing%, to within %tolerance% in x
+//	NOTE all values are in [0,1] like RollingShutterLensDistortionEngine::removeWarp
+//		and %engine% must be precomputed
+void InvertibilityDomain::compute( const RollingShutterLensDistortionEngine &engine, 
+									double xMin, double xMax, 
+									double firstRowY, double rowSpacing, int numRows, 
+									double tolerance,
+									double foldDeterminantThreshold /*= DEFAULT_FOLD_DETERMINANT_THRESHOLD*/ )
+{
+	assert( rowSpacing > 0 );
+	assert( tolerance > 0 );
+	
+	this->clear();
+	if( numRows <= 0 || engine.isIdentity() )
+		return;
+	
+	//	no fold line means every position can be solved
+	double yMax = firstRowY + rowSpacing * ( numRows - 1 );
+	if( InvertibilityDomain::isFoldFree( engine, xMin, firstRowY, xMax, yMax, foldDeterminantThreshold ) )
+		return;
+	
+	//	find interval of every row
+	this->isEverywhereInvertible = false;
+	this->firstRowY = firstRowY;
+	this->rowSpacing = rowSpacing;
+	this->leftX.assign( numRows, 1 );
+	this->rightX.assign( numRows, 0 );
+	for( int row = 0 ; row < numRows ; row++ )
+	{
+		double y = firstRowY + rowSpacing * row;
+		
+		//	probe the whole row, a row whose solvable positions have a gap could
+		//		otherwise be cut at the inner edge of the gap
+		int leftProbe = -1,
+			rightProbe = -1;
+		for( int i = 0 ; i <= NUM_ROW_SEED_SAMPLES ; i++ )
+		{
+			if( !InvertibilityDomain::canRemoveWarp( engine, Vector2( xMin + ( xMax - xMin ) * i / NUM_ROW_SEED_SAMPLES, y ) ) )
+				continue;
+			if( leftProbe < 0 )
+				leftProbe = i;
+			rightProbe = i;
+		}
+		if( leftProbe < 0 )
+			//	whole row is not invertible
+			continue;
+		
+		//	the interval spans the outermost solvable probes, only beyond them is
+		//		the edge bisected, widened by tolerance so no solvable position is skipped
+		double leftProbeX = xMin + ( xMax - xMin ) * leftProbe / NUM_ROW_SEED_SAMPLES,
+				rightProbeX = xMin + ( xMax - xMin ) * rightProbe / NUM_ROW_SEED_SAMPLES;
+		this->leftX[row] = ( leftProbe == 0 ? xMin :
+								InvertibilityDomain::findEdge( engine, y, leftProbeX, 
+																xMin + ( xMax - xMin ) * ( leftProbe - 1 ) / NUM_ROW_SEED_SAMPLES,
+																tolerance ) ) - tolerance;
+		this->rightX[row] = ( rightProbe == NUM_ROW_SEED_SAMPLES ? xMax :
+								InvertibilityDomain::findEdge( engine, y, rightProbeX, 
+																xMin + ( xMax - xMin ) * ( rightProbe + 1 ) / NUM_ROW_SEED_SAMPLES,
+																tolerance ) ) + tolerance;
+	}
+}
+
+//	reset to everywhere invertible
+void InvertibilityDomain::clear()
+{
+	this->isEverywhereInvertible = true;
+	this->leftX.clear();
+	this->rightX.clear();
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	check if jacobian determinant of %engine% stays above %threshold%
+//		all over the source region that can reach the target region
+bool InvertibilityDomain::isFoldFree( const RollingShutterLensDistortionEngine &engine, 
+										double xMin, double yMin, double xMax, double yMax,
+										double threshold )
+{
+	//	measure largest displacement over the target region, source positions
+	//		reaching the region are within that distance of it
+	double maxDisplacement = 0;
+	for( int j = 0 ; j < NUM_DISPLACEMENT_SAMPLES ; j++ )
+	{
+		for( int i = 0 ; i < NUM_DISPLACEMENT_SAMPLES ; i++ )
+		{
+			Vector2 p( xMin + ( xMax - xMin ) * i / ( NUM_DISPLACEMENT_SAMPLES - 1 ),
+						yMin + ( yMax - yMin ) * j / ( NUM_DISPLACEMENT_SAMPLES - 1 ) );
+			Vector2 displacement( engine.applyWarp( p ) - p );
+			maxDisplacement = std::max( maxDisplacement, sqrt( displacement.sqrnorm() ) );
+		}
+	}
+	
+	//	look for a fold ( jacobian determinant crossing zero ) in the expanded region
+	double margin = 1.5 * maxDisplacement;
+	double sourceXMin = xMin - margin, sourceXMax = xMax + margin,
+			sourceYMin = yMin - margin, sourceYMax = yMax + margin;
+	for( int j = 0 ; j < NUM_FOLD_SAMPLES ; j++ )
+	{
+		for( int i = 0 ; i < NUM_FOLD_SAMPLES ; i++ )
+		{
+			Vector2 p( sourceXMin + ( sourceXMax - sourceXMin ) * i / ( NUM_FOLD_SAMPLES - 1 ),
+						sourceYMin + ( sourceYMax - sourceYMin ) * j / ( NUM_FOLD_SAMPLES - 1 ) );
+			Vector2 partialX, partialY;
+			engine.computeWarpJacobian( p, &partialX, &partialY );
+			if( partialX.x * partialY.y - partialY.x * partialX.y < threshold )
+				return false;
+		}
+	}
+	
+	return true;
+}
+
+//	bisect row %y% between solvable %insideX% and unsolvable %outsideX% to
+//		within %tolerance%
+//	returns the last solvable x found
+double InvertibilityDomain::findEdge( const RollingShutterLensDistortionEngine &engine, double y, 
+										double insideX, double outsideX, double tolerance )
+{
+	while( fabs( insideX - outsideX ) > tolerance )
+	{
+		double midX = ( insideX + outsideX ) / 2;
+		if( InvertibilityDomain::canRemoveWarp( engine, Vector2( midX, y ) ) )
+			insideX = midX;
+		else
+			outsideX = midX;
+	}
+	return insideX;
+}
+
+//	check if removeWarp of %engine% can be solved at %q%
+bool InvertibilityDomain::canRemoveWarp( const RollingShutterLensDistortionEngine &engine, const Vector2 &q )
+{
+	try
+	{
+		engine.removeWarp( q );
+	}
+	catch( ynxValueException &e )
+	{
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS InvertibilityDomain MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,189 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___InvertibilityDomain_h)
+#define ___InvertibilityDomain_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <vector>
+#include <cmath>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	minimum determinant of the warp jacobian for a region to be
+//		considered free of fold lines
+#define DEFAULT_FOLD_DETERMINANT_THRESHOLD 0.05
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class InvertibilityDomain
+//
+//---------------------------------------------------------------------
+
+//	region of target positions where RollingShutterLensDistortionEngine::removeWarp
+//		can be solved, stored as an x interval for each row of a regular row lattice.
+//	When the warp jacobian has no fold line anywhere near the region the whole
+//		region is invertible and no interval is computed at all. Otherwise the
+//		interval of each row spans its outermost invertible probes, refined by
+//		bisection towards both ends of the row. Gaps inside the interval are
+//		kept, so the domain never cuts off positions beyond a gap.
+class InvertibilityDomain
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	is whole region invertible ( no fold line found )
+		bool isEverywhereInvertible;
+		
+		//	y of first row and distance between rows
+		double firstRowY, rowSpacing;
+		
+		//	invertible x interval of each row ( empty when left > right )
+		std::vector<double> leftX, rightX;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		InvertibilityDomain();
+		
+		~InvertibilityDomain();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	check if whole region is invertible
+		bool getIsEverywhereInvertible() const
+		{	return this->isEverywhereInvertible;	}
+		
+		//	get number of rows with an interval
+		int getNumRows() const
+		{	return int( this->leftX.size() );	}
+		
+		//	get memory used by intervals ( in bytes )
+		size_t getMemorySize() const
+		{	return ( this->leftX.size() + this->rightX.size() ) * sizeof( double );	}
+			
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	compute domain of %engine% over x in [%xMin%,%xMax%] for %numRows% rows at
+		//		y = %firstRowY% + i * %rowSpacing%, to within %tolerance% in x
+		//	NOTE all values are in [0,1] like RollingShutterLensDistortionEngine::removeWarp
+		//		and %engine% must be precomputed
+		void compute( const RollingShutterLensDistortionEngine &engine, 
+						double xMin, double xMax, 
+						double firstRowY, double rowSpacing, int numRows, 
+						double tolerance,
+						double foldDeterminantThreshold = DEFAULT_FOLD_DETERMINANT_THRESHOLD );
+		
+		//	reset to everywhere invertible
+		void clear();
+		
+		//	check if %q% may be invertible, false only when %q% is known to be
+		//		outside the domain so removeWarp can be skipped
+		//	NOTE positions between rows use the nearest row, positions outside
+		//		of all rows are always treated as invertible
+		bool isInvertible( const Vector2 &q ) const
+		{
+			if( this->isEverywhereInvertible )
+				return true;
+			
+			int row = int( floor( ( q.y - this->firstRowY ) / this->rowSpacing + 0.5 ) );
+			if( row < 0 || row >= int( this->leftX.size() ) )
+				return true;
+			
+			return q.x >= this->leftX[row] && q.x <= this->rightX[row];
+		}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	check if jacobian determinant of %engine% stays above %threshold%
+		//		all over the source region that can reach the target region
+		static bool isFoldFree( const RollingShutterLensDistortionEngine &engine, 
+								double xMin, double yMin, double xMax, double yMax,
+								double threshold );
+		
+		//	bisect row %y% between solvable %insideX% and unsolvable %outsideX% to
+		//		within %tolerance%
+		//	returns the last solvable x found
+		static double findEdge( const RollingShutterLensDistortionEngine &engine, double y, 
+								double insideX, double outsideX, double tolerance );
+		
+		//	check if removeWarp of %engine% can be solved at %q%
+		static bool canRemoveWarp( const RollingShutterLensDistortionEngine &engine, const Vector2 &q );
+	
+};
+//---------------------------------------------------------------------
+//	END class InvertibilityDomain
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,621 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "MotionSidecarIndex.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	number of columns of the motion and gyro layouts
+#define NUM_MOTION_COLUMNS ( 1 + NUM_MOTION_VALUES_PER_FRAME )
+#define NUM_GYRO_COLUMNS 4
+
+//	magic and version of the index file, the version is increased whenever
+//		the layout changes so old indices are parsed again
+#define MOTION_INDEX_MAGIC "YNXMOTN"
+#define MOTION_INDEX_VERSION 1
+
+//	maximum number of frames of a sidecar, guards against a bogus frame number
+#define MAX_NUM_FRAMES 10000000
+
+//	64 bit FNV-1a constants
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+//	header of the index file, followed by NUM_MOTION_VALUES_PER_FRAME
+//		floats of every frame
+struct MotionIndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	int32_t firstFrame;
+	uint32_t numFrames;
+	uint32_t numValuesPerFrame;
+	uint64_t sourceSize;
+	int64_t sourceModificationTime;
+	uint64_t conversionHash;
+};
+
+//	append bytes of a double to an FNV-1a hash
+static inline void appendHash( double value, uint64_t *hash )
+{
+	unsigned char bytes[sizeof( double )];
+	memcpy( bytes, &value, sizeof( double ) );
+	for( size_t i = 0 ; i < sizeof( double ) ; i++ )
+	{
+		*hash ^= bytes[i];
+		*hash *= FNV_PRIME;
+	}
+}
+
+//	compute hash of %conversion%
+static inline uint64_t computeConversionHash( const GyroConversion &conversion )
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	::appendHash( conversion.frameRate, &hash );
+	::appendHash( conversion.timeOffset, &hash );
+	::appendHash( conversion.focalLength, &hash );
+	return hash;
+}
+
+//	get size and modification time ( in nanoseconds ) of %path%
+//	returns false if there is no such file
+static inline bool getFileStamp( const std::string &path, uint64_t *size_ret, int64_t *modificationTime_ret )
+{
+	struct stat fileStat;
+	if( stat( path.c_str(), &fileStat ) != 0 )
+		return false;
+	*size_ret = uint64_t( fileStat.st_size );
+	*modificationTime_ret = int64_t( fileStat.st_mtim.tv_sec ) * 1000000000 + fileStat.st_mtim.tv_nsec;
+	return true;
+}
+
+//	rotate a point %ndcP% on the image plane at %focalLength% by the inverse of
+//		camera rotation %rotation% ( axis times angle ) and project it back
+//	returns false if the point ends up behind the camera
+static bool rotatePoint( const Vector2 &ndcP, const double rotation[3], double focalLength, Vector2 *rotatedP_ret )
+{
+	double angle = sqrt( rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] );
+	if( angle == 0 )
+	{
+		*rotatedP_ret = ndcP;
+		return true;
+	}
+
+	//	ray of the point, the camera looks along -z
+	double ray[3] = { ndcP.x, ndcP.y, -focalLength };
+	double axis[3] = { rotation[0] / angle, rotation[1] / angle, rotation[2] / angle };
+
+	//	rodrigues rotation by -angle
+	double cosAngle = cos( angle ),
+			sinAngle = -sin( angle );
+	double axisDotRay = axis[0] * ray[0] + axis[1] * ray[1] + axis[2] * ray[2];
+	double axisCrossRay[3] = { axis[1] * ray[2] - axis[2] * ray[1],
+								axis[2] * ray[0] - axis[0] * ray[2],
+								axis[0] * ray[1] - axis[1] * ray[0] };
+	double rotatedRay[3];
+	for( int i = 0 ; i < 3 ; i++ )
+		rotatedRay[i] = ray[i] * cosAngle + axisCrossRay[i] * sinAngle + axis[i] * axisDotRay * ( 1 - cosAngle );
+
+	if( rotatedRay[2] >= 0 )
+		return false;
+
+	rotatedP_ret->x = -focalLength * rotatedRay[0] / rotatedRay[2];
+	rotatedP_ret->y = -focalLength * rotatedRay[1] / rotatedRay[2];
+	return true;
+}
+
+//	integral of angular velocity of gyro %samples% ( time, x, y, z, sorted by
+//		time ) from the first sample to %time%, angular velocity is linear
+//		between samples. %cumulativeIntegrals% holds the integral up to every sample
+static void integrateAngularVelocity( const std::vector<double> &samples,
+										const std::vector<double> &cumulativeIntegrals,
+										double time, double integral_ret[3] )
+{
+	int numSamples = int( samples.size() ) / NUM_GYRO_COLUMNS;
+
+	//	find the segment [k,k+1] containing %time%
+	int low = 0, high = numSamples - 1;
+	while( high - low > 1 )
+	{
+		int middle = ( low + high ) / 2;
+		if( samples[middle * NUM_GYRO_COLUMNS] <= time )
+			low = middle;
+		else
+			high = middle;
+	}
+
+	const double *sample = &samples[low * NUM_GYRO_COLUMNS],
+				*nextSample = &samples[high * NUM_GYRO_COLUMNS];
+	double duration = nextSample[0] - sample[0],
+			elapsed = time - sample[0];
+	for( int i = 0 ; i < 3 ; i++ )
+	{
+		double slope = duration > 0 ? ( nextSample[i + 1] - sample[i + 1] ) / duration : 0;
+		integral_ret[i] = cumulativeIntegrals[low * 3 + i] +
+							sample[i + 1] * elapsed + slope * elapsed * elapsed / 2;
+	}
+}
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS MotionSidecarIndex MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS MotionSidecarIndex STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//	guard for the process wide index of every sidecar below
+std::mutex MotionSidecarIndex::sMutex;
+
+//	process wide index of every sidecar, keyed by path and conversion
+std::unordered_map<std::string, std::shared_ptr<const MotionSidecarIndex> > MotionSidecarIndex::sIndices;
+
+//---------------------------------------------------------------------
+//
+//	CLASS MotionSidecarIndex MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+MotionSidecarIndex::MotionSidecarIndex() : sourceSize( 0 ), sourceModificationTime( 0 ), conversionHash( 0 ),
+											firstFrame( 0 ), numFrames( 0 ), frameValues( NULL ),
+											mappedData( NULL ), mappedSize( 0 )
+{
+
+}
+MotionSidecarIndex::~MotionSidecarIndex()
+{
+	this->clear();
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	get the index of %sidecarPath% shared by the whole process, it is
+//		loaded again when the sidecar has changed since
+//	THROWS ynxValueException if the sidecar can't be read
+std::shared_ptr<const MotionSidecarIndex> MotionSidecarIndex::open( const std::string &sidecarPath,
+																	const GyroConversion &conversion )
+																throw( ynxValueException )
+{
+	std::string key = sidecarPath + "\n" + std::to_string( ::computeConversionHash( conversion ) );
+
+	//	loading under the lock makes every other op of the sidecar wait for
+	//		the one loading it instead of parsing it again
+	std::lock_guard<std::mutex> lock( MotionSidecarIndex::sMutex );
+	std::unordered_map<std::string, std::shared_ptr<const MotionSidecarIndex> >::iterator it = MotionSidecarIndex::sIndices.find( key );
+	if( it != MotionSidecarIndex::sIndices.end() && it->second->isUpToDate( sidecarPath, conversion ) )
+		return it->second;
+
+	std::shared_ptr<MotionSidecarIndex> index( new MotionSidecarIndex() );
+	index->load( sidecarPath, conversion );
+	MotionSidecarIndex::sIndices[key] = index;
+	return index;
+}
+
+//	load %sidecarPath%, mapping its index when it is up to date, else
+//		parsing the sidecar and writing the index
+//	THROWS ynxValueException if the sidecar can't be read
+void MotionSidecarIndex::load( const std::string &sidecarPath, const GyroConversion &conversion ) throw( ynxValueException )
+{
+	this->clear();
+
+	if( !::getFileStamp( sidecarPath, &this->sourceSize, &this->sourceModificationTime ) )
+		throw ynxValueException( "MotionSidecarIndex::load() : can't read sidecar " + sidecarPath );
+	this->conversionHash = ::computeConversionHash( conversion );
+
+	//	reuse the index when it was written from this sidecar
+	std::string indexPath = sidecarPath + MOTION_SIDECAR_INDEX_SUFFIX;
+	if( this->mapIndex( indexPath ) )
+		return;
+
+	//	parse and write the index for next time, values are kept in memory
+	//		when the index can't be written ( e.g. read only directory )
+	this->parseSidecar( sidecarPath, conversion );
+	this->frameValues = this->parsedValues.data();
+	if( this->writeIndex( indexPath ) && this->mapIndex( indexPath ) )
+		std::vector<float>().swap( this->parsedValues );
+}
+
+//	get motion of %frame%
+//	returns false if the frame isn't in the sidecar
+bool MotionSidecarIndex::getFrameMotion( int frame, RollingShutterSingleFrameMotion *motion_ret ) const
+{
+	if( frame < this->firstFrame || frame >= this->firstFrame + this->numFrames )
+		return false;
+
+	const float *values = this->frameValues + size_t( frame - this->firstFrame ) * NUM_MOTION_VALUES_PER_FRAME;
+	if( std::isnan( values[0] ) )
+		return false;
+
+	//	top left/middle/right then bottom left/middle/right
+	for( int i = 0 ; i < 6 ; i++ )
+	{
+		RollingShutterPointMotion *pointMotion = i < 3 ? &motion_ret->top[i] : &motion_ret->bottom[i - 3];
+		const float *pointValues = values + i * 4;
+		pointMotion->set( Vector2( pointValues[0], pointValues[1] ),
+							Vector2( pointValues[2], pointValues[3] ) );
+	}
+
+	return true;
+}
+
+//	check if this index was loaded from the current version of
+//		%sidecarPath% with %conversion%
+bool MotionSidecarIndex::isUpToDate( const std::string &sidecarPath, const GyroConversion &conversion ) const
+{
+	uint64_t size;
+	int64_t modificationTime;
+	return ::getFileStamp( sidecarPath, &size, &modificationTime ) &&
+			size == this->sourceSize && modificationTime == this->sourceModificationTime &&
+			::computeConversionHash( conversion ) == this->conversionHash;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	unmap index and forget all frames
+void MotionSidecarIndex::clear()
+{
+	if( this->mappedData != NULL )
+		munmap( this->mappedData, this->mappedSize );
+	this->mappedData = NULL;
+	this->mappedSize = 0;
+	std::vector<float>().swap( this->parsedValues );
+	this->frameValues = NULL;
+	this->firstFrame = this->numFrames = 0;
+}
+
+//	map %indexPath% if it was written from the sidecar and conversion
+//		this->sourceSize, this->sourceModificationTime, this->conversionHash
+//	returns false if there is no such index
+bool MotionSidecarIndex::mapIndex( const std::string &indexPath )
+{
+	int fileDescriptor = ::open( indexPath.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 )
+		return false;
+
+	struct stat fileStat;
+	if( fstat( fileDescriptor, &fileStat ) != 0 || size_t( fileStat.st_size ) < sizeof( MotionIndexHeader ) )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	//	the mapping stays valid after the file is closed
+	size_t size = size_t( fileStat.st_size );
+	void *data = mmap( NULL, size, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( data == MAP_FAILED )
+		return false;
+
+	//	check the index belongs to this sidecar and is complete
+	const MotionIndexHeader *header = static_cast<const MotionIndexHeader *>( data );
+	if( memcmp( header->magic, MOTION_INDEX_MAGIC, sizeof( header->magic ) ) != 0 ||
+		header->version != MOTION_INDEX_VERSION ||
+		header->numValuesPerFrame != NUM_MOTION_VALUES_PER_FRAME ||
+		header->sourceSize != this->sourceSize ||
+		header->sourceModificationTime != this->sourceModificationTime ||
+		header->conversionHash != this->conversionHash ||
+		size != sizeof( MotionIndexHeader ) + size_t( header->numFrames ) * NUM_MOTION_VALUES_PER_FRAME * sizeof( float ) )
+	{
+		munmap( data, size );
+		return false;
+	}
+
+	//	switch over to the mapping
+	if( this->mappedData != NULL )
+		munmap( this->mappedData, this->mappedSize );
+	this->mappedData = data;
+	this->mappedSize = size;
+	this->firstFrame = header->firstFrame;
+	this->numFrames = int( header->numFrames );
+	this->frameValues = reinterpret_cast<const float *>( static_cast<const char *>( data ) + sizeof( MotionIndexHeader ) );
+	return true;
+}
+
+//	write this->parsedValues to %indexPath%, the index is written to
+//		a temporary file first and renamed so readers never see half of it
+//	returns false if it can't be written
+bool MotionSidecarIndex::writeIndex( const std::string &indexPath ) const
+{
+	MotionIndexHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, MOTION_INDEX_MAGIC, sizeof( header.magic ) );
+	header.version = MOTION_INDEX_VERSION;
+	header.firstFrame = this->firstFrame;
+	header.numFrames = uint32_t( this->numFrames );
+	header.numValuesPerFrame = NUM_MOTION_VALUES_PER_FRAME;
+	header.sourceSize = this->sourceSize;
+	header.sourceModificationTime = this->sourceModificationTime;
+	header.conversionHash = this->conversionHash;
+
+	//	temporary file is unique per process so concurrent farm tasks don't clash
+	std::string temporaryPath = indexPath + ".tmp." + std::to_string( getpid() );
+	FILE *file = fopen( temporaryPath.c_str(), "wb" );
+	if( file == NULL )
+		return false;
+
+	bool isWritten = fwrite( &header, sizeof( header ), 1, file ) == 1 &&
+						fwrite( this->parsedValues.data(), sizeof( float ), this->parsedValues.size(), file ) == this->parsedValues.size();
+	isWritten = ( fclose( file ) == 0 ) && isWritten;
+	if( !isWritten || rename( temporaryPath.c_str(), indexPath.c_str() ) != 0 )
+	{
+		unlink( temporaryPath.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+//	parse %sidecarPath% into this->firstFrame, this->numFrames and
+//		this->parsedValues
+//	THROWS ynxValueException if the sidecar can't be read
+void MotionSidecarIndex::parseSidecar( const std::string &sidecarPath, const GyroConversion &conversion ) throw( ynxValueException )
+{
+	std::ifstream file( sidecarPath.c_str() );
+	if( !file )
+		throw ynxValueException( "MotionSidecarIndex::parseSidecar() : can't read sidecar " + sidecarPath );
+
+	//	read all rows, every row has the number of columns of the first
+	std::vector<double> rows;
+	int numColumns = 0, lineNumber = 0;
+	bool isHeaderAllowed = true;
+	std::string line;
+	std::vector<double> columns;
+	while( std::getline( file, line ) )
+	{
+		lineNumber++;
+
+		//	skip blank and comment lines
+		size_t start = line.find_first_not_of( " \t\r" );
+		if( start == std::string::npos || line[start] == '#' )
+			continue;
+
+		//	split at commas
+		columns.clear();
+		bool isNumeric = true;
+		const char *field = line.c_str() + start;
+		for( ; ; )
+		{
+			char *end;
+			double value = strtod( field, &end );
+			while( *end == ' ' || *end == '\t' || *end == '\r' )
+				end++;
+			if( end == field || ( *end != ',' && *end != '\0' ) )
+				isNumeric = false;
+			columns.push_back( value );
+
+			const char *comma = strchr( field, ',' );
+			if( comma == NULL )
+				break;
+			field = comma + 1;
+		}
+
+		//	the first line may be a header
+		if( !isNumeric )
+		{
+			if( isHeaderAllowed )
+			{
+				isHeaderAllowed = false;
+				continue;
+			}
+			throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath +
+										" line " + std::to_string( lineNumber ) + " is not numeric" );
+		}
+		isHeaderAllowed = false;
+
+		if( numColumns == 0 )
+		{
+			numColumns = int( columns.size() );
+			if( numColumns != NUM_MOTION_COLUMNS && numColumns != NUM_GYRO_COLUMNS )
+				throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath +
+											" has " + std::to_string( numColumns ) + " columns, expected " +
+											std::to_string( NUM_MOTION_COLUMNS ) + " ( motion ) or " +
+											std::to_string( NUM_GYRO_COLUMNS ) + " ( gyro )" );
+		}
+		else if( int( columns.size() ) != numColumns )
+			throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath +
+										" line " + std::to_string( lineNumber ) + " has a different number of columns" );
+
+		rows.insert( rows.end(), columns.begin(), columns.end() );
+	}
+
+	if( rows.empty() )
+		throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath + " has no data" );
+
+	int numRows = int( rows.size() ) / numColumns;
+
+	//	gyro samples are converted to frames
+	if( numColumns == NUM_GYRO_COLUMNS )
+	{
+		//	sort samples by time
+		std::vector<int> order( numRows );
+		for( int i = 0 ; i < numRows ; i++ )
+			order[i] = i;
+		std::stable_sort( order.begin(), order.end(),
+							[&rows]( int a, int b ) { return rows[a * NUM_GYRO_COLUMNS] < rows[b * NUM_GYRO_COLUMNS]; } );
+		std::vector<double> samples( rows.size() );
+		for( int i = 0 ; i < numRows ; i++ )
+			std::copy( rows.begin() + order[i] * NUM_GYRO_COLUMNS, rows.begin() + ( order[i] + 1 ) * NUM_GYRO_COLUMNS,
+						samples.begin() + i * NUM_GYRO_COLUMNS );
+
+		this->convertGyroSamples( samples, conversion );
+		return;
+	}
+
+	//	motion rows are frames already, find the frame range
+	double minFrame = rows[0], maxFrame = rows[0];
+	for( int i = 0 ; i < numRows ; i++ )
+	{
+		double frame = rows[i * numColumns];
+		if( frame != floor( frame ) )
+			throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath +
+										" has a frame number which is not an integer" );
+		minFrame = std::min( minFrame, frame );
+		maxFrame = std::max( maxFrame, frame );
+	}
+	if( maxFrame - minFrame + 1 > MAX_NUM_FRAMES )
+		throw ynxValueException( "MotionSidecarIndex::parseSidecar() : " + sidecarPath + " has too many frames" );
+
+	this->firstFrame = int( minFrame );
+	this->numFrames = int( maxFrame - minFrame ) + 1;
+	this->parsedValues.assign( size_t( this->numFrames ) * NUM_MOTION_VALUES_PER_FRAME,
+								std::numeric_limits<float>::quiet_NaN() );
+	for( int i = 0 ; i < numRows ; i++ )
+	{
+		const double *row = &rows[i * numColumns];
+		float *values = &this->parsedValues[size_t( int( row[0] ) - this->firstFrame ) * NUM_MOTION_VALUES_PER_FRAME];
+		for( int k = 0 ; k < NUM_MOTION_VALUES_PER_FRAME ; k++ )
+			values[k] = float( row[k + 1] );
+	}
+}
+
+//	convert gyro %samples% ( time and angular velocity x, y, z of every
+//		sample, sorted by time ) to this->firstFrame, this->numFrames
+//		and this->parsedValues
+//	THROWS ynxValueException if the samples don't cover a whole frame
+void MotionSidecarIndex::convertGyroSamples( const std::vector<double> &samples,
+												const GyroConversion &conversion ) throw( ynxValueException )
+{
+	int numSamples = int( samples.size() ) / NUM_GYRO_COLUMNS;
+	if( numSamples < 2 || !( conversion.frameRate > 0 ) || !( conversion.focalLength > 0 ) )
+		throw ynxValueException( "MotionSidecarIndex::convertGyroSamples() : not enough samples or bad conversion" );
+
+	//	integral of angular velocity up to every sample ( trapezoids )
+	std::vector<double> cumulativeIntegrals( numSamples * 3, 0. );
+	for( int k = 1 ; k < numSamples ; k++ )
+	{
+		const double *sample = &samples[( k - 1 ) * NUM_GYRO_COLUMNS],
+					*nextSample = &samples[k * NUM_GYRO_COLUMNS];
+		for( int i = 0 ; i < 3 ; i++ )
+			cumulativeIntegrals[k * 3 + i] = cumulativeIntegrals[( k - 1 ) * 3 + i] +
+												( sample[i + 1] + nextSample[i + 1] ) * ( nextSample[0] - sample[0] ) / 2;
+	}
+
+	//	frames whose previous and next frame intervals are both covered
+	double frameDuration = 1 / conversion.frameRate,
+			startTime = samples[0],
+			endTime = samples[( numSamples - 1 ) * NUM_GYRO_COLUMNS];
+	double firstFrame = ceil( ( startTime + frameDuration - conversion.timeOffset ) * conversion.frameRate - 1e-9 ),
+			lastFrame = floor( ( endTime - frameDuration - conversion.timeOffset ) * conversion.frameRate + 1e-9 );
+	if( lastFrame < firstFrame )
+		throw ynxValueException( "MotionSidecarIndex::convertGyroSamples() : samples don't cover a whole frame" );
+	if( lastFrame - firstFrame + 1 > MAX_NUM_FRAMES )
+		throw ynxValueException( "MotionSidecarIndex::convertGyroSamples() : samples cover too many frames" );
+
+	this->firstFrame = int( firstFrame );
+	this->numFrames = int( lastFrame - firstFrame ) + 1;
+	this->parsedValues.assign( size_t( this->numFrames ) * NUM_MOTION_VALUES_PER_FRAME,
+								std::numeric_limits<float>::quiet_NaN() );
+
+	for( int frameIndex = 0 ; frameIndex < this->numFrames ; frameIndex++ )
+	{
+		//	camera rotation from this frame to the previous and next frames
+		double time = conversion.timeOffset + ( this->firstFrame + frameIndex ) * frameDuration;
+		double integral[3], previousIntegral[3], nextIntegral[3];
+		::integrateAngularVelocity( samples, cumulativeIntegrals, time, integral );
+		::integrateAngularVelocity( samples, cumulativeIntegrals, time - frameDuration, previousIntegral );
+		::integrateAngularVelocity( samples, cumulativeIntegrals, time + frameDuration, nextIntegral );
+		double previousRotation[3], nextRotation[3];
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			previousRotation[i] = previousIntegral[i] - integral[i];
+			nextRotation[i] = nextIntegral[i] - integral[i];
+		}
+
+		//	move top left/middle/right then bottom left/middle/right, a frame
+		//		with any point behind the camera is left missing
+		float values[NUM_MOTION_VALUES_PER_FRAME];
+		bool isValid = true;
+		for( int i = 0 ; i < 6 && isValid ; i++ )
+		{
+			Vector2 position( i < 3 ? RollingShutterLensDistortionEngine::getTopPointPosition( i ) :
+										RollingShutterLensDistortionEngine::getBottomPointPosition( i - 3 ) );
+			Vector2 previousPosition, nextPosition;
+			isValid = ::rotatePoint( position, previousRotation, conversion.focalLength, &previousPosition ) &&
+						::rotatePoint( position, nextRotation, conversion.focalLength, &nextPosition );
+			values[i * 4] = float( previousPosition.x );
+			values[i * 4 + 1] = float( previousPosition.y );
+			values[i * 4 + 2] = float( nextPosition.x );
+			values[i * 4 + 3] = float( nextPosition.y );
+		}
+		if( isValid )
+			std::copy( values, values + NUM_MOTION_VALUES_PER_FRAME,
+						this->parsedValues.begin() + size_t( frameIndex ) * NUM_MOTION_VALUES_PER_FRAME );
+	}
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS MotionSidecarIndex MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
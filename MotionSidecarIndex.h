@@ -0,0 +1,249 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___MotionSidecarIndex_h)
+#define ___MotionSidecarIndex_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <stdint.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	number of values of a frame's motion ( previous and next x, y
+//		of top left/middle/right and bottom left/middle/right )
+#define NUM_MOTION_VALUES_PER_FRAME 24
+
+//	suffix appended to the sidecar path to get the index path
+#define MOTION_SIDECAR_INDEX_SUFFIX ".ynxmotion"
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class GyroConversion
+//
+//---------------------------------------------------------------------
+
+//	how gyro samples are converted to the motion of frames
+class GyroConversion
+{
+	public:
+		//	frames per second, and gyro time ( in seconds ) at which frame 0
+		//		is captured ( its center scanline )
+		double frameRate, timeOffset;
+
+		//	focal length in NDC ( the image width spans [-1,1] )
+		double focalLength;
+
+	public:
+		//contructors/destructors
+		GyroConversion() : frameRate( 24 ), timeOffset( 0 ), focalLength( 2 )
+		{
+		}
+
+};
+//---------------------------------------------------------------------
+//	END class GyroConversion
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class MotionSidecarIndex
+//
+//---------------------------------------------------------------------
+
+//	per frame RollingShutterSingleFrameMotion read from a CSV sidecar. Two
+//		layouts are read, told apart by their number of columns:
+//		- motion, 25 columns: frame, then previous x, previous y, next x, next y
+//			( in NDC ) of top left, top middle, top right, bottom left,
+//			bottom middle and bottom right, like the node's knobs
+//		- gyro, 4 columns: time ( in seconds ), then angular velocity of the
+//			camera ( in radians per second ) around its x ( right ), y ( up ) and
+//			z ( backward ) axes. Rotation over the previous and next frame
+//			intervals moves every point by GyroConversion::focalLength
+//		Lines starting with '#' and a header line are skipped.
+//	The parsed frames are written to a compact binary index next to the
+//		sidecar ( MOTION_SIDECAR_INDEX_SUFFIX ) which is memory mapped when
+//		it is loaded again, as long as the sidecar and conversion are unchanged
+class MotionSidecarIndex
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//	size and modification time ( in nanoseconds ) of the sidecar loaded,
+		//		and hash of the conversion it was loaded with
+		uint64_t sourceSize;
+		int64_t sourceModificationTime;
+		uint64_t conversionHash;
+
+		//	first frame and number of frames, values of frame f start at
+		//		frameValues[( f - firstFrame ) * NUM_MOTION_VALUES_PER_FRAME],
+		//		a NaN first value marks a frame missing from the sidecar
+		int firstFrame, numFrames;
+		const float *frameValues;
+
+		//	memory mapped index ( NULL when the index couldn't be written,
+		//		the values are then kept in this->parsedValues )
+		void *mappedData;
+		size_t mappedSize;
+		std::vector<float> parsedValues;
+
+		//	guard for the process wide index of every sidecar below
+		static std::mutex sMutex;
+
+		//	process wide index of every sidecar, keyed by path and conversion
+		static std::unordered_map<std::string, std::shared_ptr<const MotionSidecarIndex> > sIndices;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		MotionSidecarIndex();
+
+		~MotionSidecarIndex();
+
+	private:
+		//	not copyable, the mapping is owned
+		MotionSidecarIndex( const MotionSidecarIndex & );
+		MotionSidecarIndex &operator=( const MotionSidecarIndex & );
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get frame range
+		int getFirstFrame() const
+		{	return this->firstFrame;	}
+		int getNumFrames() const
+		{	return this->numFrames;	}
+
+		//	check if values are read from a memory mapped index
+		bool isMemoryMapped() const
+		{	return this->mappedData != NULL;	}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get the index of %sidecarPath% shared by the whole process, it is
+		//		loaded again when the sidecar has changed since
+		//	THROWS ynxValueException if the sidecar can't be read
+		static std::shared_ptr<const MotionSidecarIndex> open( const std::string &sidecarPath,
+																const GyroConversion &conversion )
+															throw( ynxValueException );
+
+		//	load %sidecarPath%, mapping its index when it is up to date, else
+		//		parsing the sidecar and writing the index
+		//	THROWS ynxValueException if the sidecar can't be read
+		void load( const std::string &sidecarPath, const GyroConversion &conversion ) throw( ynxValueException );
+
+		//	get motion of %frame%
+		//	returns false if the frame isn't in the sidecar
+		bool getFrameMotion( int frame, RollingShutterSingleFrameMotion *motion_ret ) const;
+
+		//	check if this index was loaded from the current version of
+		//		%sidecarPath% with %conversion%
+		bool isUpToDate( const std::string &sidecarPath, const GyroConversion &conversion ) const;
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+		//	unmap index and forget all frames
+		void clear();
+
+		//	map %indexPath% if it was written from the sidecar and conversion
+		//		this->sourceSize, this->sourceModificationTime, this->conversionHash
+		//	returns false if there is no such index
+		bool mapIndex( const std::string &indexPath );
+
+		//	write this->parsedValues to %indexPath%, the index is written to
+		//		a temporary file first and renamed so readers never see half of it
+		//	returns false if it can't be written
+		bool writeIndex( const std::string &indexPath ) const;
+
+		//	parse %sidecarPath% into this->firstFrame, this->numFrames and
+		//		this->parsedValues
+		//	THROWS ynxValueException if the sidecar can't be read
+		void parseSidecar( const std::string &sidecarPath, const GyroConversion &conversion ) throw( ynxValueException );
+
+		//	convert gyro %samples% ( time and angular velocity x, y, z of every
+		//		sample, sorted by time ) to this->firstFrame, this->numFrames
+		//		and this->parsedValues
+		//	THROWS ynxValueException if the samples don't cover a whole frame
+		void convertGyroSamples( const std::vector<double> &samples,
+									const GyroConversion &conversion ) throw( ynxValueException );
+
+};
+//---------------------------------------------------------------------
+//	END class MotionSidecarIndex
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,108 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___PointNormalization_h)
+#define ___PointNormalization_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	debug flags
+// #define DEBUG_NORMAILIZE_POINT
+
+#ifdef DEBUG_NORMAILIZE_POINT
+#	include <iostream>
+#endif
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//	convert from image space to normalized [0,1] [( 1 - height/width )/2,height/width + ( 1 - height/width )/2] space 
+inline void normalizePoint( const Vector2 &p, 
+									double imageWidth, double imageHeight, 
+									double pixelAspectRatio, 
+									Vector2 *normalizedP_ret )
+{
+#ifdef DEBUG_NORMAILIZE_POINT
+	std::cout << "\n **********************************************" << std::endl;
+	std::cout << "   normalizePoint( p = ( " << p.x << ", " << p.y 
+				<< " ), width = " << imageWidth << ", height = " << imageHeight
+				<< ", pixelAspectRatio = " << pixelAspectRatio << " )" << std::endl;
+#endif
+	//	unsqueeze
+	normalizedP_ret->copy( p );
+	normalizedP_ret->x *= pixelAspectRatio;
+#ifdef DEBUG_NORMAILIZE_POINT
+	std::cout << "  unsqueeze = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
+#endif
+	//	Convert coordinate to [0,1], [0,height/width]
+	normalizedP_ret->divide( imageWidth * pixelAspectRatio );
+
+#ifdef DEBUG_NORMAILIZE_POINT
+	std::cout << "  convert to [0,1], [0,height/width] = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
+#endif
+
+	//	Convert coordinate to [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ]
+	normalizedP_ret->y += ( 1 - ( imageHeight / imageWidth / pixelAspectRatio ) ) / 2;
+
+#ifdef DEBUG_NORMAILIZE_POINT
+	std::cout << "  convert to [-1,1], [-height/width,height/width] = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
+#endif			
+}
+
+//	convert from normalized [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ] space
+//		to image space
+inline void unnormalizePoint( const Vector2 &p, 
+										double imageWidth, double imageHeight, 
+										double pixelAspectRatio, 
+										Vector2 *unnormalizedP_ret )
+									throw( ynxValueException )
+{
+	//	Convert coordinate to [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ]
+	unnormalizedP_ret->copy( p ); 
+ 	unnormalizedP_ret->y -= ( 1 - ( imageHeight / imageWidth / pixelAspectRatio ) ) / 2;			
+
+	//	Convert coordinate to [0,1], [0,height/width]
+	unnormalizedP_ret->multiply( imageWidth * pixelAspectRatio );
+
+	//	Unsqueeze
+	unnormalizedP_ret->x /= pixelAspectRatio;			
+}
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
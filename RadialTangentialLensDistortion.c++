@@ -0,0 +1,230 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <cmath>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RadialTangentialLensDistortion.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	maximum number of newton iterations of undistort
+#define MAX_NUM_ITERATIONS 100
+
+//	maximum number of times a newton step is halved when it doesn't improve
+#define MAX_NUM_STEP_HALVINGS 16
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS RadialTangentialLensDistortion MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS RadialTangentialLensDistortion STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS RadialTangentialLensDistortion MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+RadialTangentialLensDistortion::RadialTangentialLensDistortion()
+{
+	this->setToIdentityDefaults();
+}
+RadialTangentialLensDistortion::~RadialTangentialLensDistortion()
+{
+
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	set all coefficients to 0 ( identity )
+void RadialTangentialLensDistortion::setToIdentityDefaults()
+{
+	this->k1 = this->k2 = this->k3 = 0;
+	this->p1 = this->p2 = 0;
+}
+
+//	compute analytic partial derivatives of this->distort at %ndcP% when
+//		moving in pure x ( %partialX_ret% ) or y ( %partialY_ret% )
+void RadialTangentialLensDistortion::computeDistortJacobian( const Vector2 &ndcP, Vector2 *partialX_ret, Vector2 *partialY_ret ) const
+{
+	double x = ndcP.x,
+			y = ndcP.y,
+			rr = x * x + y * y;
+
+	//	radial scale and its derivative with respect to r^2
+	double radialScale = 1 + rr * ( this->k1 + rr * ( this->k2 + rr * this->k3 ) ),
+			radialScaleDrr = this->k1 + rr * ( 2 * this->k2 + rr * 3 * this->k3 );
+
+	//	both mixed partials of the distorted position are equal
+	double mixed = 2 * x * y * radialScaleDrr + 2 * this->p1 * x + 2 * this->p2 * y;
+
+	partialX_ret->x = radialScale + 2 * x * x * radialScaleDrr + 2 * this->p1 * y + 6 * this->p2 * x;
+	partialX_ret->y = mixed;
+	partialY_ret->x = mixed;
+	partialY_ret->y = radialScale + 2 * y * y * radialScaleDrr + 6 * this->p1 * y + 2 * this->p2 * x;
+}
+
+//	cheaply predict this->undistort by two fixed point steps of
+//		p = q - offset(p), starting at p = q
+Vector2 RadialTangentialLensDistortion::predictUndistort( const Vector2 &ndcQ ) const
+{
+	Vector2 predictedP( ndcQ - ( this->distort( ndcQ ) - ndcQ ) );
+	return ndcQ - ( this->distort( predictedP ) - predictedP );
+}
+
+//	numerically invert this->distort to within %numericalError% ( in NDC )
+//	THROWS ynxValueException if it isn't solved, e.g. beyond the radius where
+//		strong barrel distortion folds back ( jacobian determinant <= 0 )
+Vector2 RadialTangentialLensDistortion::undistort( const Vector2 &ndcQ, double numericalError ) const throw( ynxValueException )
+{
+	double epsilonSqr = numericalError * numericalError;
+
+	//	start from the prediction, which is already close for mild distortion
+	Vector2 p( this->predictUndistort( ndcQ ) );
+	Vector2 error( this->distort( p ) - ndcQ );
+	double sqrError = error.sqrnorm();
+
+	for( int iterCount = 0 ; iterCount < MAX_NUM_ITERATIONS ; iterCount++ )
+	{
+		if( sqrError < epsilonSqr )
+			return p;
+
+		//	newton step by cramer's rule, stop at a fold
+		Vector2 partialX, partialY;
+		this->computeDistortJacobian( p, &partialX, &partialY );
+		double determinant = partialX.x * partialY.y - partialY.x * partialX.y;
+		if( !( determinant > 0 ) )
+			throw ynxValueException( "RadialTangentialLensDistortion::undistort() : folded distortion! Giving up!" );
+		Vector2 step( ( error.x * partialY.y - partialY.x * error.y ) / determinant,
+						( partialX.x * error.y - error.x * partialX.y ) / determinant );
+
+		//	halve the step until it improves
+		double stepScalar = 1;
+		int numStepHalvings = 0;
+		for( ; ; )
+		{
+			Vector2 improvedP( p.x - step.x * stepScalar, p.y - step.y * stepScalar );
+			Vector2 improvedError( this->distort( improvedP ) - ndcQ );
+			double improvedSqrError = improvedError.sqrnorm();
+			if( improvedSqrError < sqrError )
+			{
+				p = improvedP;
+				error = improvedError;
+				sqrError = improvedSqrError;
+				break;
+			}
+
+			if( ++numStepHalvings > MAX_NUM_STEP_HALVINGS )
+				throw ynxValueException( "RadialTangentialLensDistortion::undistort() : tiny stepScalar, and still no improvement! Giving up!" );
+			stepScalar /= 2;
+		}
+	}
+
+	if( sqrError < epsilonSqr )
+		return p;
+	throw ynxValueException( "RadialTangentialLensDistortion::undistort() : iterCount exceeds numerical maximum! Giving up!" );
+}
+
+//	get upper bound of |this->distort( p )| for |p| <= %radius%
+double RadialTangentialLensDistortion::computeMaxDistortedRadius( double radius ) const
+{
+	double rr = radius * radius;
+
+	//	|p * radialScale| plus the tangential terms, which are at most
+	//		4 ( |p1| + |p2| ) r^2 together
+	return radius * ( 1 + rr * ( fabs( this->k1 ) + rr * ( fabs( this->k2 ) + rr * fabs( this->k3 ) ) ) ) +
+			4 * ( fabs( this->p1 ) + fabs( this->p2 ) ) * rr;
+}
+
+//	get upper bound of the stretch ( lipschitz constant ) of
+//		this->distort for |p| <= %radius%
+double RadialTangentialLensDistortion::computeMaxStretch( double radius ) const
+{
+	double rr = radius * radius;
+
+	//	radial jacobian is radialScale * I + 2 radialScale' p p^T, whose norm is at
+	//		most 1 + sum of ( 2i + 1 ) |ki| r^2i, and the tangential gradients are
+	//		at most 8 ( |p1| + |p2| ) r together
+	return 1 + rr * ( 3 * fabs( this->k1 ) + rr * ( 5 * fabs( this->k2 ) + rr * 7 * fabs( this->k3 ) ) ) +
+			8 * ( fabs( this->p1 ) + fabs( this->p2 ) ) * radius;
+}
+
+//	get upper bound of |this->distort( p ) - other.distort( p )|
+//		for |p| <= %radius%
+double RadialTangentialLensDistortion::computeMaxDistortDifference( const RadialTangentialLensDistortion &other, double radius ) const
+{
+	double rr = radius * radius;
+
+	//	distortion is linear in its coefficients, so this is the distorted
+	//		radius bound of the coefficient differences minus the identity part
+	return radius * rr * ( fabs( this->k1 - other.k1 ) +
+							rr * ( fabs( this->k2 - other.k2 ) + rr * fabs( this->k3 - other.k3 ) ) ) +
+			4 * ( fabs( this->p1 - other.p1 ) + fabs( this->p2 - other.p2 ) ) * rr;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	END CLASS RadialTangentialLensDistortion MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___RadialTangentialLensDistortion_h)
+#define ___RadialTangentialLensDistortion_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#ifdef YNX_STANDALONE
+//	using yannix minimal as a header for yxnexception and ynxmath (Vector2 and ParabolicFit)
+#	include "YnxMinimal.h"
+#else
+//	yannix exception
+#	include <ynxexception/ynxValueException.h>
+//	yannix math
+#	include <ynxmath/Vector2.h>
+#endif
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+#ifdef YNX_STANDALONE
+	using Vector2 = YnxMinimal::Vector2;
+	using ynxValueException = YnxMinimal::ynxValueException;
+#endif
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class RadialTangentialLensDistortion
+//
+//---------------------------------------------------------------------
+
+//	brown-conrady lens distortion with three radial ( k1, k2, k3 ) and two
+//		tangential ( p1, p2 ) coefficients. Positions are in NDC with the
+//		optical center at the origin and the image width spanning [-1,1],
+//		an undistorted position p is distorted to
+//			p * ( 1 + k1 r^2 + k2 r^4 + k3 r^6 ) + tangential( p ), r = |p|
+//		where tangential( p ) = ( 2 p1 x y + p2 ( r^2 + 2 x^2 ),
+//									p1 ( r^2 + 2 y^2 ) + 2 p2 x y )
+class RadialTangentialLensDistortion
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//	radial coefficients of r^2, r^4 and r^6
+		double k1, k2, k3;
+
+		//	tangential coefficients
+		double p1, p2;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		RadialTangentialLensDistortion();
+
+		~RadialTangentialLensDistortion();
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	get/set radial coefficients
+		double getK1() const
+		{	return this->k1;	}
+		void setK1( double value )
+		{	this->k1 = value;	}
+		double *getK1Ptr()
+		{	return &this->k1;	}
+		double getK2() const
+		{	return this->k2;	}
+		void setK2( double value )
+		{	this->k2 = value;	}
+		double *getK2Ptr()
+		{	return &this->k2;	}
+		double getK3() const
+		{	return this->k3;	}
+		void setK3( double value )
+		{	this->k3 = value;	}
+		double *getK3Ptr()
+		{	return &this->k3;	}
+
+		//	get/set tangential coefficients
+		double getP1() const
+		{	return this->p1;	}
+		void setP1( double value )
+		{	this->p1 = value;	}
+		double *getP1Ptr()
+		{	return &this->p1;	}
+		double getP2() const
+		{	return this->p2;	}
+		void setP2( double value )
+		{	this->p2 = value;	}
+		double *getP2Ptr()
+		{	return &this->p2;	}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//	set all coefficients to 0 ( identity )
+		void setToIdentityDefaults();
+
+		//	check if all coefficients are 0
+		bool isIdentity() const
+		{
+			return this->k1 == 0 && this->k2 == 0 && this->k3 == 0 &&
+					this->p1 == 0 && this->p2 == 0;
+		}
+
+		//	check if all coefficients are equal to those of %other%
+		bool isEqual( const RadialTangentialLensDistortion &other ) const
+		{
+			return this->k1 == other.k1 && this->k2 == other.k2 && this->k3 == other.k3 &&
+					this->p1 == other.p1 && this->p2 == other.p2;
+		}
+
+		//	distort undistorted position %ndcP%
+		Vector2 distort( const Vector2 &ndcP ) const
+		{
+			double xx = ndcP.x * ndcP.x,
+					yy = ndcP.y * ndcP.y,
+					xy = ndcP.x * ndcP.y,
+					rr = xx + yy;
+			double radialScale = 1 + rr * ( this->k1 + rr * ( this->k2 + rr * this->k3 ) );
+			return Vector2( ndcP.x * radialScale + 2 * this->p1 * xy + this->p2 * ( rr + 2 * xx ),
+							ndcP.y * radialScale + this->p1 * ( rr + 2 * yy ) + 2 * this->p2 * xy );
+		}
+
+		//	compute analytic partial derivatives of this->distort at %ndcP% when
+		//		moving in pure x ( %partialX_ret% ) or y ( %partialY_ret% )
+		void computeDistortJacobian( const Vector2 &ndcP, Vector2 *partialX_ret, Vector2 *partialY_ret ) const;
+
+		//	cheaply predict this->undistort by two fixed point steps of
+		//		p = q - offset(p), starting at p = q
+		Vector2 predictUndistort( const Vector2 &ndcQ ) const;
+
+		//	numerically invert this->distort to within %numericalError% ( in NDC )
+		//	THROWS ynxValueException if it isn't solved, e.g. beyond the radius where
+		//		strong barrel distortion folds back ( jacobian determinant <= 0 )
+		Vector2 undistort( const Vector2 &ndcQ, double numericalError ) const throw( ynxValueException );
+
+		//	get upper bound of |this->distort( p )| for |p| <= %radius%
+		double computeMaxDistortedRadius( double radius ) const;
+
+		//	get upper bound of the stretch ( lipschitz constant ) of
+		//		this->distort for |p| <= %radius%
+		double computeMaxStretch( double radius ) const;
+
+		//	get upper bound of |this->distort( p ) - other.distort( p )|
+		//		for |p| <= %radius%
+		double computeMaxDistortDifference( const RadialTangentialLensDistortion &other, double radius ) const;
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+};
+//---------------------------------------------------------------------
+//	END class RadialTangentialLensDistortion
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
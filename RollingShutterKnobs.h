@@ -0,0 +1,181 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___RollingShutterKnobs_h)
+#define ___RollingShutterKnobs_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//	Nuke
+#include <DDImage/Knobs.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//	yannix lens distortion engine
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	defines
+#define FARAWAYDEPTH 1e10
+
+#define DEFAULT_LOWER_BOUND_VALUE -2
+#define DEFAULT_UPPER_BOUND_VALUE 2
+
+//	names of inverse solvers in the order of InverseSolver
+static const char * const INVERSE_SOLVER_NAMES[] = { "newton", "bracketed", 0 };
+
+//	names of lens distortion orders in the order of LensDistortionOrder
+static const char * const LENS_DISTORTION_ORDER_NAMES[] = { "lens then rolling shutter", "rolling shutter then lens", 0 };
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//	create knobs of the warp parameters of %engine% ( rolling shutter ratio, depths,
+//		lens distortion and motion ), shared by every rolling shutter node so
+//		their knobs have the same names and values can be copied between them
+inline void rollingShutterEngineKnobs( DD::Image::Knob_Callback f, RollingShutterLensDistortionEngine *engine )
+{
+	//	get pointer to relevant parameters
+	double *rollingShutterRatioPtr = engine->getRollingShutterRatioPtr();
+	double *topPointDepthPtr = engine->getTopPointDepthPtr();
+	double *bottomPointDepthPtr = engine->getBottomPointDepthPtr();
+	RollingShutterSingleFrameMotion *currentMotionDataPtr = engine->getCurrentMotionDataPtr();
+	RadialTangentialLensDistortion *lensDistortionPtr = engine->getLensDistortionPtr();
+	int *lensDistortionOrderPtr = engine->getLensDistortionOrderPtr();
+	
+	//	knob for to set value for rolling shutter ratio
+	Double_knob(f, rollingShutterRatioPtr, DD::Image::IRange(0, 1), "rollingShutterRatio");
+	
+	//	knob for to set value for top point depth
+	Double_knob(f, topPointDepthPtr, DD::Image::IRange(0, FARAWAYDEPTH), "topPointDepth");
+	
+	//	knob for to set value for bottom point depth
+	Double_knob(f, bottomPointDepthPtr, DD::Image::IRange(0, FARAWAYDEPTH), "bottomPointDepth");
+	
+	//------------------------------------
+	//	Lens distortion
+	
+	//	knob for to set radial ( k1, k2, k3 ) and tangential ( p1, p2 ) lens distortion
+	//		coefficients, in NDC where the image width spans [-1,1]. All zero is no lens distortion
+	Double_knob(f, lensDistortionPtr->getK1Ptr(), DD::Image::IRange(-1, 1), "k1");
+	Double_knob(f, lensDistortionPtr->getK2Ptr(), DD::Image::IRange(-1, 1), "k2");
+	Double_knob(f, lensDistortionPtr->getK3Ptr(), DD::Image::IRange(-1, 1), "k3");
+	Double_knob(f, lensDistortionPtr->getP1Ptr(), DD::Image::IRange(-0.1, 0.1), "p1");
+	Double_knob(f, lensDistortionPtr->getP2Ptr(), DD::Image::IRange(-0.1, 0.1), "p2");
+	
+	//	knob for to choose whether lens distortion is applied before or after
+	//		rolling shutter, both are resampled at once
+	Enumeration_knob(f, lensDistortionOrderPtr, LENS_DISTORTION_ORDER_NAMES, "lensDistortionOrder");
+	
+	//------------------------------------
+	//	Top
+	
+	//	knob for to set value for top left previous x
+	Double_knob(f, &currentMotionDataPtr->top[0].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftPrevX");
+	
+	//	knob for to set value for top left previous y
+	Double_knob(f, &currentMotionDataPtr->top[0].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftPrevY");
+	
+	//	knob for to set value for top left next x
+	Double_knob(f, &currentMotionDataPtr->top[0].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftNextX");
+	
+	//	knob for to set value for top left next y
+	Double_knob(f, &currentMotionDataPtr->top[0].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftNextY");
+
+	//	knob for to set value for top middle previous x
+	Double_knob(f, &currentMotionDataPtr->top[1].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddlePrevX");
+	
+	//	knob for to set value for top middle previous y
+	Double_knob(f, &currentMotionDataPtr->top[1].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddlePrevY");
+	
+	//	knob for to set value for top middle next x
+	Double_knob(f, &currentMotionDataPtr->top[1].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddleNextX");
+	
+	//	knob for to set value for top middle next y
+	Double_knob(f, &currentMotionDataPtr->top[1].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddleNextY");
+	
+	//	knob for to set value for top right previous x
+	Double_knob(f, &currentMotionDataPtr->top[2].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightPrevX");
+	
+	//	knob for to set value for top right previous y
+	Double_knob(f, &currentMotionDataPtr->top[2].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightPrevY");
+	
+	//	knob for to set value for top right next x
+	Double_knob(f, &currentMotionDataPtr->top[2].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightNextX");
+	
+	//	knob for to set value for top right next y
+	Double_knob(f, &currentMotionDataPtr->top[2].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightNextY");
+	
+	//------------------------------------
+	//	Bottom
+
+	//	knob for to set value for bottom left previous x
+	Double_knob(f, &currentMotionDataPtr->bottom[0].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftPrevX");
+	
+	//	knob for to set value for bottom left previous y
+	Double_knob(f, &currentMotionDataPtr->bottom[0].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftPrevY");
+	
+	//	knob for to set value for bottom left next x
+	Double_knob(f, &currentMotionDataPtr->bottom[0].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftNextX");
+	
+	//	knob for to set value for bottom left next y
+	Double_knob(f, &currentMotionDataPtr->bottom[0].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftNextY");
+
+	//	knob for to set value for bottom middle previous x
+	Double_knob(f, &currentMotionDataPtr->bottom[1].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddlePrevX");
+	
+	//	knob for to set value for bottom middle previous y
+	Double_knob(f, &currentMotionDataPtr->bottom[1].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddlePrevY");
+	
+	//	knob for to set value for bottom middle next x
+	Double_knob(f, &currentMotionDataPtr->bottom[1].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddleNextX");
+	
+	//	knob for to set value for bottom middle next y
+	Double_knob(f, &currentMotionDataPtr->bottom[1].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddleNextY");
+	
+	//	knob for to set value for bottom right previous x
+	Double_knob(f, &currentMotionDataPtr->bottom[2].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightPrevX");
+	
+	//	knob for to set value for bottom right previous y
+	Double_knob(f, &currentMotionDataPtr->bottom[2].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightPrevY");
+	
+	//	knob for to set value for bottom right next x
+	Double_knob(f, &currentMotionDataPtr->bottom[2].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightNextX");
+	
+	//	knob for to set value for bottom right next y
+	Double_knob(f, &currentMotionDataPtr->bottom[2].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightNextY");
+}
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -13,6 +13,9 @@
 //---------------------------------------------------------------------
 
 #include <assert.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
 
 //---------------------------------------------------------------------
 //
@@ -25,6 +28,9 @@
 //	invert warp func 
 #include "InvertWarpFuncs.h"
 
+//	per thread memory for span buffers
+#include "ScratchArena.h"
+
 //---------------------------------------------------------------------
 //	DEFINES AND INLINES
 //---------------------------------------------------------------------
@@ -32,6 +38,51 @@
 #define EPSILON 1e-7
 #define FARAWAYDEPTH 1e10
 
+//	64 bit FNV-1a constants
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+//	append bytes of a double to an FNV-1a hash
+static inline void appendHash( double value, uint64_t *hash )
+{
+	//	treat -0 as 0 so equal parameters always hash equally
+	if( value == 0 )
+		value = 0;
+	
+	unsigned char bytes[sizeof( double )];
+	memcpy( bytes, &value, sizeof( double ) );
+	for( size_t i = 0 ; i < sizeof( double ) ; i++ )
+	{
+		*hash ^= bytes[i];
+		*hash *= FNV_PRIME;
+	}
+}
+
+//	get upper bound of the difference of two warp offsets in NDC given by
+//		parabolic fits %fits% and %otherFits% ( top x, bottom x, top y, bottom y )
+//		for |x| and |y| up to %ndcExtent%
+static double computeMaxOffsetFitDifference( const ParabolicFit * const fits[4], 
+												const ParabolicFit * const otherFits[4],
+												double ndcExtent )
+{
+	//	the offset in NDC is top(x) * ( y^2 + y )/2 + bottom(x) * ( y^2 - y )/2,
+	//		both weights are at most ( e^2 + e )/2 and each fit difference at most
+	//		|da| e^2 + |db| e + |dc| for extent e
+	double weight = ( ndcExtent * ndcExtent + ndcExtent ) / 2;
+	double maxDifference = 0;
+	for( int component = 0 ; component < 2 ; component++ )
+	{
+		double difference = 0;
+		for( int i = component * 2 ; i < component * 2 + 2 ; i++ )
+			difference += ( fabs( fits[i]->a - otherFits[i]->a ) * ndcExtent + 
+							fabs( fits[i]->b - otherFits[i]->b ) ) * ndcExtent + 
+							fabs( fits[i]->c - otherFits[i]->c );
+		maxDifference = std::max( maxDifference, difference * weight );
+	}
+	
+	return maxDifference;
+}
+
 //---------------------------------------------------------------------
 //	GLOBALS
 //---------------------------------------------------------------------
@@ -87,10 +138,13 @@ const Vector2 RollingShutterLensDistortionEngine::sTopPointPosition[3] =
 	//---------------------------------------------------------------------
 	//	public contructors/destructors
 	//---------------------------------------------------------------------
-RollingShutterLensDistortionEngine::RollingShutterLensDistortionEngine()
+RollingShutterLensDistortionEngine::RollingShutterLensDistortionEngine() : invertWarpStatistics( NULL )
 {
 	//	Initial default
 	this->setToIdentityDefaults();
+	
+	//	identity warp offsets until parameters are set and precomputed again
+	this->precompute();
 }
 RollingShutterLensDistortionEngine::~RollingShutterLensDistortionEngine()
 {
@@ -166,6 +220,13 @@ void RollingShutterLensDistortionEngine::setToIdentityDefaults()
 	//	Rolling shutter ratio
 	this->rollingShutterRatio = 0;
 	
+	//	numerical inverse
+	this->inverseSolver = INVERSE_SOLVER_NEWTON;
+	
+	//	no lens distortion
+	this->lensDistortion.setToIdentityDefaults();
+	this->lensDistortionOrder = LENS_DISTORTION_BEFORE_ROLLING_SHUTTER;
+	
  	//	Top and bottom point depth
  	this->topPointDepth = this->bottomPointDepth = FARAWAYDEPTH;
 }
@@ -175,6 +236,10 @@ void RollingShutterLensDistortionEngine::setToIdentityDefaults()
 //		warp
 bool RollingShutterLensDistortionEngine::isIdentity() const
 {
+	//	Check for identity of lens distortion
+	if( !this->lensDistortion.isIdentity() )
+		return false;
+	
 	//	Check for identity of rolling shutter distortion	
 	if( ( this->rollingShutterRatio - 0.0 ) <= EPSILON )
 	{
@@ -186,39 +251,199 @@ bool RollingShutterLensDistortionEngine::isIdentity() const
 	return false;	
 }
 
-//	do a mathematically "forward" warp to a pixel.
+//	compute a hash of all warp parameters, objects with
+//		identical parameters have identical hashes. %motion%
+//		replaces the current motion when given
+uint64_t RollingShutterLensDistortionEngine::computeParameterHash( const RollingShutterSingleFrameMotion *motion /*= NULL*/ ) const
+{
+	if( motion == NULL )
+		motion = &this->currentMotionData;
+	
+	uint64_t hash = FNV_OFFSET_BASIS;
+	
+	//	scalar parameters
+	::appendHash( this->rollingShutterRatio, &hash );
+	::appendHash( this->topPointDepth, &hash );
+	::appendHash( this->bottomPointDepth, &hash );
+	::appendHash( this->inverseSolver, &hash );
+	
+	//	lens distortion
+	::appendHash( this->lensDistortion.getK1(), &hash );
+	::appendHash( this->lensDistortion.getK2(), &hash );
+	::appendHash( this->lensDistortion.getK3(), &hash );
+	::appendHash( this->lensDistortion.getP1(), &hash );
+	::appendHash( this->lensDistortion.getP2(), &hash );
+	::appendHash( this->lensDistortionOrder, &hash );
+	
+	//	motion of all top/bottom points
+	for( int i = 0 ; i < 3 ; i ++ )
+	{
+		const RollingShutterPointMotion *pointMotions[2] = { &motion->top[i], 
+															&motion->bottom[i] };
+		for( int k = 0 ; k < 2 ; k ++ )
+		{
+			::appendHash( pointMotions[k]->previousPosition.x, &hash );
+			::appendHash( pointMotions[k]->previousPosition.y, &hash );
+			::appendHash( pointMotions[k]->nextPosition.x, &hash );
+			::appendHash( pointMotions[k]->nextPosition.y, &hash );
+		}
+	}
+	
+	return hash;
+}
+
+//	do a mathematically "forward" warp to a pixel, this is the lens
+//		distortion and rolling shutter warp composed in the order
+//		of this->lensDistortionOrder
 //	NOTE for subclass implementers: %p% is in [0,1]
 //		REMEMBER THAT!
 Vector2 RollingShutterLensDistortionEngine::applyWarp( const Vector2 &p ) const throw( ynxValueException )
 {
-	// Normailize given position
-	Vector2 ndcP( this->convertEffectivePixelToNdc( p.x ),
-					this->convertEffectivePixelToNdc( p.y ) );
+	if( this->lensDistortion.isIdentity() )
+		return this->applyRollingShutterWarp( p );
+	
+	if( this->lensDistortionOrder == LENS_DISTORTION_AFTER_ROLLING_SHUTTER )
+		return this->applyLensDistortion( this->applyRollingShutterWarp( p ) );
+	return this->applyRollingShutterWarp( this->applyLensDistortion( p ) );
+}
 
+//	compute analytic partial derivatives of this->applyWarp at %p%
+//		when moving in pure x ( %partialX_ret% ) or y ( %partialY_ret% )
+//	NOTE %p% is in [0,1] like this->applyWarp
+void RollingShutterLensDistortionEngine::computeWarpJacobian( const Vector2 &p, Vector2 *partialX_ret, Vector2 *partialY_ret ) const
+{
+	if( this->lensDistortion.isIdentity() )
+	{
+		this->computeRollingShutterWarpJacobian( p, partialX_ret, partialY_ret );
+		return;
+	}
+	
+	//	jacobians of the first and second stage, scaling to/from NDC
+	//		cancels so the lens jacobian in NDC is used as is
+	Vector2 firstPartialX, firstPartialY, secondPartialX, secondPartialY;
+	if( this->lensDistortionOrder == LENS_DISTORTION_AFTER_ROLLING_SHUTTER )
+	{
+		this->computeRollingShutterWarpJacobian( p, &firstPartialX, &firstPartialY );
+		Vector2 rollingShutterP( this->applyRollingShutterWarp( p ) );
+		this->lensDistortion.computeDistortJacobian( Vector2( this->convertEffectivePixelToNdc( rollingShutterP.x ),
+																this->convertEffectivePixelToNdc( rollingShutterP.y ) ), 
+														&secondPartialX, &secondPartialY );
+	}
+	else
+	{
+		this->lensDistortion.computeDistortJacobian( Vector2( this->convertEffectivePixelToNdc( p.x ),
+																this->convertEffectivePixelToNdc( p.y ) ), 
+														&firstPartialX, &firstPartialY );
+		this->computeRollingShutterWarpJacobian( this->applyLensDistortion( p ), &secondPartialX, &secondPartialY );
+	}
+	
+	//	chain rule, each partial of the first stage is mapped by the second
+	partialX_ret->x = secondPartialX.x * firstPartialX.x + secondPartialY.x * firstPartialX.y;
+	partialX_ret->y = secondPartialX.y * firstPartialX.x + secondPartialY.y * firstPartialX.y;
+	partialY_ret->x = secondPartialX.x * firstPartialY.x + secondPartialY.x * firstPartialY.y;
+	partialY_ret->y = secondPartialX.y * firstPartialY.x + secondPartialY.y * firstPartialY.y;
+}
 
-	//	Create parabolic fit for top
-	ParabolicFit fitTopX( this->topPointWarpOffset[0].x, 
-							this->topPointWarpOffset[1].x,
-							this->topPointWarpOffset[2].x );
-	ParabolicFit fitTopY( this->topPointWarpOffset[0].y, 
-							this->topPointWarpOffset[1].y,
-							this->topPointWarpOffset[2].y );						
+//	cheaply predict this->removeWarp from the warp offset by two
+//		fixed point steps of p = q - offset(p), starting at p = q
+Vector2 RollingShutterLensDistortionEngine::predictRemoveWarp( const Vector2 &q ) const
+{
+	//	first step uses the offset at q itself
+	Vector2 predictedP( q - ( this->applyWarp( q ) - q ) );
+	
+	//	second step corrects for the change of offset between q and
+	//		the first prediction
+	return q - ( this->applyWarp( predictedP ) - predictedP );
+}
 
-	//	Interpolate top
-	Vector2 interpolateTop( fitTopX.f( ndcP.x ), 
-							fitTopY.f( ndcP.x ) );
+//	numerically invert this->applyWarp, the inverse of each stage
+//		is solved separately in reverse order
+Vector2 RollingShutterLensDistortionEngine::removeWarp( const Vector2 &q ) const throw( ynxValueException )
+{
+	if( this->lensDistortion.isIdentity() )
+		return this->removeRollingShutterWarp( q );
+	
+	if( this->lensDistortionOrder == LENS_DISTORTION_AFTER_ROLLING_SHUTTER )
+		return this->removeRollingShutterWarp( this->removeLensDistortion( q ) );
+	return this->removeLensDistortion( this->removeRollingShutterWarp( q ) );
+}
+
+//	numerically invert this->applyWarp for %numPoints% points of %q%,
+//		on entry a false in %isSolved_ret% skips that point, on return it
+//		tells whether the point is solved ( failures don't throw ).
+//		Solves start at %initialGuesses% if given, else at this->predictRemoveWarp
+void RollingShutterLensDistortionEngine::removeWarpSpan( const Vector2 *q, int numPoints, Vector2 *p_ret, bool *isSolved_ret,
+															const Vector2 *initialGuesses /*= NULL*/ ) const
+{
+	if( this->lensDistortion.isIdentity() )
+	{
+		this->removeRollingShutterWarpSpan( q, numPoints, p_ret, isSolved_ret, initialGuesses );
+		return;
+	}
+	
+	if( this->lensDistortionOrder == LENS_DISTORTION_AFTER_ROLLING_SHUTTER )
+	{
+		//	remove lens distortion first, then the rolling shutter span, whose
+		//		source positions are the same as those of the composite
+		for( int i = 0 ; i < numPoints ; i++ )
+		{
+			if( !isSolved_ret[i] )
+				continue;
+			try
+			{
+				p_ret[i] = this->removeLensDistortion( q[i] );
+			}
+			catch( ynxValueException &e )
+			{
+				isSolved_ret[i] = false;
+			}
+		}
+		this->removeRollingShutterWarpSpan( p_ret, numPoints, p_ret, isSolved_ret, initialGuesses );
+		return;
+	}
+	
+	//	rolling shutter span first, its source positions are lens distorted
+	//		so initial guesses are distorted as well
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	Vector2 *rollingShutterGuesses = NULL;
+	if( initialGuesses != NULL )
+	{
+		rollingShutterGuesses = scratchArena.allocate<Vector2>( numPoints );
+		for( int i = 0 ; i < numPoints ; i++ )
+			rollingShutterGuesses[i] = this->applyLensDistortion( initialGuesses[i] );
+	}
+	this->removeRollingShutterWarpSpan( q, numPoints, p_ret, isSolved_ret, rollingShutterGuesses );
+	
+	//	then remove lens distortion of every solved point
+	for( int i = 0 ; i < numPoints ; i++ )
+	{
+		if( !isSolved_ret[i] )
+			continue;
+		try
+		{
+			p_ret[i] = this->removeLensDistortion( p_ret[i] );
+		}
+		catch( ynxValueException &e )
+		{
+			isSolved_ret[i] = false;
+		}
+	}
+}
 
+//	rolling shutter warp of %p% in [0,1] without lens distortion
+Vector2 RollingShutterLensDistortionEngine::applyRollingShutterWarp( const Vector2 &p ) const
+{
+	// Normailize given position
+	Vector2 ndcP( this->convertEffectivePixelToNdc( p.x ),
+					this->convertEffectivePixelToNdc( p.y ) );
 
-	//	Create parabolic fit for bottom
-	ParabolicFit fitBottomX( this->bottomPointWarpOffset[0].x, 
-							this->bottomPointWarpOffset[1].x,
-							this->bottomPointWarpOffset[2].x );
-	ParabolicFit fitBottomY( this->bottomPointWarpOffset[0].y, 
-							this->bottomPointWarpOffset[1].y,
-							this->bottomPointWarpOffset[2].y );						
 
-	Vector2 interpolateBottom( fitBottomX.f( ndcP.x ), 
-							fitBottomY.f( ndcP.x ) );						
+	//	Interpolate top and bottom with precomputed parabolic fits
+	Vector2 interpolateTop( this->topOffsetFitX.f( ndcP.x ), 
+							this->topOffsetFitY.f( ndcP.x ) );
+	Vector2 interpolateBottom( this->bottomOffsetFitX.f( ndcP.x ), 
+							this->bottomOffsetFitY.f( ndcP.x ) );						
 
 	//	Create parabolic fit for vertical
 	ParabolicFit fitVerticalX( interpolateBottom.x, 0, 
@@ -238,17 +463,193 @@ Vector2 RollingShutterLensDistortionEngine::applyWarp( const Vector2 &p ) const
 					this->convertNdcToEffectivePixel( ndcP.y ) );	
 }
 
-//	numerically invert this->applyWarp
-Vector2 RollingShutterLensDistortionEngine::removeWarp( const Vector2 &q ) const throw( ynxValueException )
+//	compute analytic partial derivatives of this->applyRollingShutterWarp
+void RollingShutterLensDistortionEngine::computeRollingShutterWarpJacobian( const Vector2 &p, Vector2 *partialX_ret, Vector2 *partialY_ret ) const
+{
+	//	Normailize given position
+	double ndcX = this->convertEffectivePixelToNdc( p.x ),
+			ndcY = this->convertEffectivePixelToNdc( p.y );
+	
+	//	the vertical parabola through bottom (-1), 0 and top (1) offsets is
+	//		offset = top * ( y^2 + y )/2 + bottom * ( y^2 - y )/2
+	double topWeight = ( ndcY * ndcY + ndcY ) / 2,
+			bottomWeight = ( ndcY * ndcY - ndcY ) / 2,
+			topWeightDy = ndcY + 0.5,
+			bottomWeightDy = ndcY - 0.5;
+	
+	//	top/bottom offsets and their derivatives along x
+	double topX = this->topOffsetFitX.f( ndcX ),
+			topY = this->topOffsetFitY.f( ndcX ),
+			bottomX = this->bottomOffsetFitX.f( ndcX ),
+			bottomY = this->bottomOffsetFitY.f( ndcX );
+	double topXDx = 2 * this->topOffsetFitX.a * ndcX + this->topOffsetFitX.b,
+			topYDx = 2 * this->topOffsetFitY.a * ndcX + this->topOffsetFitY.b,
+			bottomXDx = 2 * this->bottomOffsetFitX.a * ndcX + this->bottomOffsetFitX.b,
+			bottomYDx = 2 * this->bottomOffsetFitY.a * ndcX + this->bottomOffsetFitY.b;
+	
+	//	scaling to/from NDC cancels, so the jacobian is identity plus
+	//		derivatives of the offset in NDC
+	partialX_ret->x = 1 + topXDx * topWeight + bottomXDx * bottomWeight;
+	partialX_ret->y = topYDx * topWeight + bottomYDx * bottomWeight;
+	partialY_ret->x = topX * topWeightDy + bottomX * bottomWeightDy;
+	partialY_ret->y = 1 + topY * topWeightDy + bottomY * bottomWeightDy;
+}
+
+//	same as this->predictRemoveWarp for this->applyRollingShutterWarp
+Vector2 RollingShutterLensDistortionEngine::predictRemoveRollingShutterWarp( const Vector2 &q ) const
+{
+	Vector2 predictedP( q - ( this->applyRollingShutterWarp( q ) - q ) );
+	return q - ( this->applyRollingShutterWarp( predictedP ) - predictedP );
+}
+
+//	numerically invert this->applyRollingShutterWarp by this->inverseSolver
+Vector2 RollingShutterLensDistortionEngine::removeRollingShutterWarp( const Vector2 &q ) const throw( ynxValueException )
 {
 // 	//	do nothing when invert warp func do not set
 // 	if( this->invertWarpFunc == NULL )
 // 		return;
+	
+	//	start from the predicted position so the solver starts
+	//		close to the answer even for large offsets
+	Vector2 initialRemoveWarpGuessQ( this->predictRemoveRollingShutterWarp( q ) );
+	
+	//	solve without statistics
+	if( this->invertWarpStatistics == NULL )
+	{
+		if( this->inverseSolver == INVERSE_SOLVER_BRACKETED )
+			return InvertWarpFuncs::removeWarpBracketed( *this, 
+										initialRemoveWarpGuessQ, 
+										q
+										);
+		return InvertWarpFuncs::removeWarp( *this, 
+									initialRemoveWarpGuessQ, 
+									q
+									);
+	}
+	
+	//	solve and collect statistics
+	InvertWarpStats stats;
+	try
+	{
+		Vector2 p;
+		if( this->inverseSolver == INVERSE_SOLVER_BRACKETED )
+			p = InvertWarpFuncs::removeWarpBracketed( *this, 
+										initialRemoveWarpGuessQ, 
+										q,
+										DEFAULT_NUMERICAL_ERROR,
+										&stats );
+		else
+			p = InvertWarpFuncs::removeWarp( *this, 
+										initialRemoveWarpGuessQ, 
+										q,
+										DEFAULT_NUMERICAL_ERROR,
+										&stats );
+		this->invertWarpStatistics->add( stats );
+		return p;
+	}
+	catch( ynxValueException &e )
+	{
+		this->invertWarpStatistics->add( stats );
+		throw;
+	}
+}
+
+//	same as this->removeWarpSpan for this->applyRollingShutterWarp
+void RollingShutterLensDistortionEngine::removeRollingShutterWarpSpan( const Vector2 *q, int numPoints, Vector2 *p_ret, bool *isSolved_ret,
+																		const Vector2 *initialGuesses /*= NULL*/ ) const
+{
+	//	newton is solved lane parallel
+	if( this->inverseSolver == INVERSE_SOLVER_NEWTON )
+	{
+		InvertWarpFuncs::removeWarpSpan( *this, 
+									q, 
+									numPoints, 
+									p_ret, 
+									isSolved_ret, 
+									DEFAULT_NUMERICAL_ERROR, 
+									this->invertWarpStatistics,
+									initialGuesses );
+		return;
+	}
+	
+	//	other solvers one point at a time
+	for( int i = 0 ; i < numPoints ; i++ )
+	{
+		if( !isSolved_ret[i] )
+			continue;
 		
-	return InvertWarpFuncs::removeWarp( *this, 
-								/*initialRemoveWarpGuessQ = */ q, 
-								q
-								);
+		InvertWarpStats stats;
+		try
+		{
+			if( initialGuesses == NULL )
+				p_ret[i] = this->removeRollingShutterWarp( q[i] );
+			else
+			{
+				p_ret[i] = InvertWarpFuncs::removeWarpBracketed( *this, 
+												initialGuesses[i], 
+												q[i],
+												DEFAULT_NUMERICAL_ERROR,
+												&stats );
+				if( this->invertWarpStatistics != NULL )
+					this->invertWarpStatistics->add( stats );
+			}
+		}
+		catch( ynxValueException &e )
+		{
+			if( initialGuesses != NULL && this->invertWarpStatistics != NULL )
+				this->invertWarpStatistics->add( stats );
+			isSolved_ret[i] = false;
+		}
+	}
+}
+
+//	numerically invert this->applyLensDistortion
+Vector2 RollingShutterLensDistortionEngine::removeLensDistortion( const Vector2 &q ) const throw( ynxValueException )
+{
+	//	numerical error is scaled to NDC
+	Vector2 ndcP( this->lensDistortion.undistort( Vector2( this->convertEffectivePixelToNdc( q.x ),
+																this->convertEffectivePixelToNdc( q.y ) ),
+													2 * DEFAULT_NUMERICAL_ERROR ) );
+	return Vector2( this->convertNdcToEffectivePixel( ndcP.x ),
+					this->convertNdcToEffectivePixel( ndcP.y ) );
+}
+
+//	get upper bound of the difference of warp offsets of this and %other% 
+//		over the whole image ( in [0,1] like this->applyWarp ), both must be
+//		precomputed. HUGE_VAL when lens distortions differ
+double RollingShutterLensDistortionEngine::computeMaxWarpOffsetDifference( const RollingShutterLensDistortionEngine &other ) const
+{
+	const ParabolicFit *fits[4] = { &this->topOffsetFitX, &this->bottomOffsetFitX,
+									&this->topOffsetFitY, &this->bottomOffsetFitY },
+						*otherFits[4] = { &other.topOffsetFitX, &other.bottomOffsetFitX,
+									&other.topOffsetFitY, &other.bottomOffsetFitY };
+	
+	//	rolling shutter only, |x| and |y| are at most 1 over the image
+	if( this->lensDistortion.isIdentity() && other.lensDistortion.isIdentity() )
+		return ::computeMaxOffsetFitDifference( fits, otherFits, 1 ) / 2;
+	
+	//	the lens stage is shared, so the difference is only that of the
+	//		rolling shutter stage, which is simply bounded over a bigger
+	//		region when the lens goes first
+	if( !this->lensDistortion.isEqual( other.lensDistortion ) || 
+		this->lensDistortionOrder != other.lensDistortionOrder )
+		return HUGE_VAL;
+	
+	double maxImageRadius = sqrt( 2. );
+	if( this->lensDistortionOrder == LENS_DISTORTION_BEFORE_ROLLING_SHUTTER )
+	{
+		double ndcExtent = std::max( 1., this->lensDistortion.computeMaxDistortedRadius( maxImageRadius ) );
+		return ::computeMaxOffsetFitDifference( fits, otherFits, ndcExtent ) / 2;
+	}
+	
+	//	when the lens goes last the rolling shutter difference is stretched by
+	//		the lens anywhere the rolling shutter stage can move the image to
+	ParabolicFit zeroFit( 0, 0, 0 );
+	const ParabolicFit *zeroFits[4] = { &zeroFit, &zeroFit, &zeroFit, &zeroFit };
+	double maxOffset = std::max( ::computeMaxOffsetFitDifference( fits, zeroFits, 1 ),
+									::computeMaxOffsetFitDifference( otherFits, zeroFits, 1 ) );
+	double stretch = this->lensDistortion.computeMaxStretch( maxImageRadius + maxOffset );
+	return stretch * ::computeMaxOffsetFitDifference( fits, otherFits, 1 ) / 2;
 }
 
 	//---------------------------------------------------------------------
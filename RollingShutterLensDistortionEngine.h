@@ -15,6 +15,8 @@
 //---------------------------------------------------------------------
 
 #include <vector>
+#include <stdint.h>
+#include <stddef.h>
 
 //---------------------------------------------------------------------
 //
@@ -33,6 +35,9 @@
 #	include <ynxmath/interpolate/ParabolicFit.h>
 #endif
 
+//	radial/tangential lens distortion composed with the rolling shutter warp
+#include "RadialTangentialLensDistortion.h"
+
 //---------------------------------------------------------------------
 //
 //	DEFINES
@@ -45,6 +50,27 @@
 	using ynxValueException = YnxMinimal::ynxValueException;
 #endif
 
+//	numerical inverse used by RollingShutterLensDistortionEngine::removeWarp
+enum InverseSolver
+{
+	//	damped 2D newton with finite difference partial derivatives
+	INVERSE_SOLVER_NEWTON = 0,
+	//	closed form x for a candidate y and bracketed 1D root find of y
+	INVERSE_SOLVER_BRACKETED,
+	NUM_INVERSE_SOLVERS
+};
+
+//	order of lens distortion and rolling shutter warp in
+//		RollingShutterLensDistortionEngine::applyWarp
+enum LensDistortionOrder
+{
+	//	lens distortion is applied to a position first, then rolling shutter
+	LENS_DISTORTION_BEFORE_ROLLING_SHUTTER = 0,
+	//	rolling shutter is applied first, then lens distortion
+	LENS_DISTORTION_AFTER_ROLLING_SHUTTER,
+	NUM_LENS_DISTORTION_ORDERS
+};
+
 
 //---------------------------------------------------------------------
 //
@@ -220,6 +246,14 @@ class RollingShutterLensDistortionEngine
 
 		//	Top and bottom point depth
  		double topPointDepth, bottomPointDepth;
+		
+		//	numerical inverse used by this->removeWarp ( InverseSolver )
+		int inverseSolver;
+		
+		//	lens distortion composed with the rolling shutter warp, and
+		//		which one is applied first ( LensDistortionOrder )
+		RadialTangentialLensDistortion lensDistortion;
+		int lensDistortionOrder;
 	
 		//	point position for top/middle/bottom points and whether their
 		//		values have been initialized
@@ -231,9 +265,18 @@ class RollingShutterLensDistortionEngine
 		Vector2 bottomPointWarpOffset[3], 
 				topPointWarpOffset[3];
 		
+		//	parabolic fit of warp offset along top and bottom edges, fitted
+		//		from the point warp offsets above in this->precompute()
+		ParabolicFit topOffsetFitX, topOffsetFitY,
+					bottomOffsetFitX, bottomOffsetFitY;
+		
 		//	current frame motion
 		RollingShutterSingleFrameMotion currentMotionData;
 		
+		//	statistics of numerical inverses in this->removeWarp
+		//		( not collected when NULL )
+		class InvertWarpStatistics *invertWarpStatistics;
+		
 	//---------------------------------------------------------------------
 	//	private member data
 	//---------------------------------------------------------------------
@@ -274,6 +317,28 @@ class RollingShutterLensDistortionEngine
 		double *getBottomPointDepthPtr()
 		{	return &this->bottomPointDepth;	}
 				
+		//	get/set numerical inverse used by this->removeWarp
+		int getInverseSolver() const
+		{	return this->inverseSolver;	}
+		void setInverseSolver( int value )
+		{	this->inverseSolver = value;	}
+		int *getInverseSolverPtr()
+		{	return &this->inverseSolver;	}
+		
+		//	get lens distortion composed with the rolling shutter warp
+		const RadialTangentialLensDistortion &getLensDistortion() const
+		{	return this->lensDistortion;	}
+		RadialTangentialLensDistortion *getLensDistortionPtr()
+		{	return &this->lensDistortion;	}
+		
+		//	get/set order of lens distortion and rolling shutter warp
+		int getLensDistortionOrder() const
+		{	return this->lensDistortionOrder;	}
+		void setLensDistortionOrder( int value )
+		{	this->lensDistortionOrder = value;	}
+		int *getLensDistortionOrderPtr()
+		{	return &this->lensDistortionOrder;	}
+				
 		//	set top left/middle/right point previous and next parameters
 		void setTopLeftPrevNextPoint( const Vector2 &topLeftPrev, 
 										const Vector2 &topLeftNext );
@@ -307,9 +372,26 @@ class RollingShutterLensDistortionEngine
 		Vector2 getTopPointWarpOffset( int i ) const
 		{ return this->topPointWarpOffset[i]; }
 		
+		//	get precomputed parabolic fit of warp offset along top/bottom edge
+		//		( offset in NDC as a function of x in NDC )
+		const ParabolicFit &getTopOffsetFitX() const
+		{ return this->topOffsetFitX; }
+		const ParabolicFit &getTopOffsetFitY() const
+		{ return this->topOffsetFitY; }
+		const ParabolicFit &getBottomOffsetFitX() const
+		{ return this->bottomOffsetFitX; }
+		const ParabolicFit &getBottomOffsetFitY() const
+		{ return this->bottomOffsetFitY; }
+		
 		//	get pointer to current motion data
 		RollingShutterSingleFrameMotion *getCurrentMotionDataPtr()
 		{	return &this->currentMotionData; }
+		
+		//	get/set statistics collected by this->removeWarp ( NULL to stop collecting )
+		class InvertWarpStatistics *getInvertWarpStatistics() const
+		{	return this->invertWarpStatistics; }
+		void setInvertWarpStatistics( class InvertWarpStatistics *value )
+		{	this->invertWarpStatistics = value; }
 			
 	//---------------------------------------------------------------------
 	//	public member functions
@@ -352,20 +434,114 @@ class RollingShutterLensDistortionEngine
 
 			}
 			
+			//	fit parabola along top and bottom edges
+			this->topOffsetFitX.fitUnitData( this->topPointWarpOffset[0].x, 
+												this->topPointWarpOffset[1].x,
+												this->topPointWarpOffset[2].x );
+			this->topOffsetFitY.fitUnitData( this->topPointWarpOffset[0].y, 
+												this->topPointWarpOffset[1].y,
+												this->topPointWarpOffset[2].y );
+			this->bottomOffsetFitX.fitUnitData( this->bottomPointWarpOffset[0].x, 
+												this->bottomPointWarpOffset[1].x,
+												this->bottomPointWarpOffset[2].x );
+			this->bottomOffsetFitY.fitUnitData( this->bottomPointWarpOffset[0].y, 
+												this->bottomPointWarpOffset[1].y,
+												this->bottomPointWarpOffset[2].y );
+			
+		}
+			
+		//	copy values computed by this->precompute() from an object
+		//		with identical parameters instead of computing them
+		void copyPrecomputedValues( const RollingShutterLensDistortionEngine &other )
+		{
+			for( int i = 0 ; i < 3 ; i ++ )
+			{
+				this->bottomPointWarpOffset[i] = other.bottomPointWarpOffset[i];
+				this->topPointWarpOffset[i] = other.topPointWarpOffset[i];
+			}
+			this->topOffsetFitX = other.topOffsetFitX;
+			this->topOffsetFitY = other.topOffsetFitY;
+			this->bottomOffsetFitX = other.bottomOffsetFitX;
+			this->bottomOffsetFitY = other.bottomOffsetFitY;
 		}
 			
 		//	check if this distortion object has any effect
 		//		at all or whether it is simply an identity
 		//		warp
 		bool isIdentity() const;
+		
+		//	compute a hash of all warp parameters, objects with
+		//		identical parameters have identical hashes. %motion%
+		//		replaces the current motion when given
+		uint64_t computeParameterHash( const RollingShutterSingleFrameMotion *motion = NULL ) const;
 			
-		//	do a mathematically "forward" warp to a pixel.
+		//	do a mathematically "forward" warp to a pixel, this is the lens
+		//		distortion and rolling shutter warp composed in the order
+		//		of this->lensDistortionOrder
 		//	NOTE for subclass implementers: %p% is in [0,1]
 		//		REMEMBER THAT!
 		Vector2 applyWarp( const Vector2 &p ) const throw( ynxValueException );
 		
-		//	numerically invert this->applyWarp
+		//	compute analytic partial derivatives of this->applyWarp at %p%
+		//		when moving in pure x ( %partialX_ret% ) or y ( %partialY_ret% )
+		//	NOTE %p% is in [0,1] like this->applyWarp
+		void computeWarpJacobian( const Vector2 &p, Vector2 *partialX_ret, Vector2 *partialY_ret ) const;
+		
+		//	cheaply predict this->removeWarp from the warp offset by two
+		//		fixed point steps of p = q - offset(p), starting at p = q
+		Vector2 predictRemoveWarp( const Vector2 &q ) const;
+		
+		//	numerically invert this->applyWarp, the inverse of each stage
+		//		is solved separately in reverse order
 		Vector2 removeWarp( const Vector2 &q ) const throw( ynxValueException );
+		
+		//	numerically invert this->applyWarp for %numPoints% points of %q%,
+		//		on entry a false in %isSolved_ret% skips that point, on return it
+		//		tells whether the point is solved ( failures don't throw ).
+		//		Solves start at %initialGuesses% if given, else at this->predictRemoveWarp
+		void removeWarpSpan( const Vector2 *q, int numPoints, Vector2 *p_ret, bool *isSolved_ret,
+								const Vector2 *initialGuesses = NULL ) const;
+		
+		//----------------------------------
+		//	rolling shutter stage only
+		//
+		
+		//	rolling shutter warp of %p% in [0,1] without lens distortion
+		Vector2 applyRollingShutterWarp( const Vector2 &p ) const;
+		
+		//	compute analytic partial derivatives of this->applyRollingShutterWarp
+		void computeRollingShutterWarpJacobian( const Vector2 &p, Vector2 *partialX_ret, Vector2 *partialY_ret ) const;
+		
+		//	same as this->predictRemoveWarp for this->applyRollingShutterWarp
+		Vector2 predictRemoveRollingShutterWarp( const Vector2 &q ) const;
+		
+		//	numerically invert this->applyRollingShutterWarp by this->inverseSolver
+		Vector2 removeRollingShutterWarp( const Vector2 &q ) const throw( ynxValueException );
+		
+		//	same as this->removeWarpSpan for this->applyRollingShutterWarp
+		void removeRollingShutterWarpSpan( const Vector2 *q, int numPoints, Vector2 *p_ret, bool *isSolved_ret,
+											const Vector2 *initialGuesses = NULL ) const;
+		
+		//----------------------------------
+		//	lens distortion stage only
+		//
+		
+		//	lens distortion of %p% in [0,1]
+		Vector2 applyLensDistortion( const Vector2 &p ) const
+		{
+			Vector2 ndcP( this->lensDistortion.distort( Vector2( this->convertEffectivePixelToNdc( p.x ),
+																	this->convertEffectivePixelToNdc( p.y ) ) ) );
+			return Vector2( this->convertNdcToEffectivePixel( ndcP.x ),
+							this->convertNdcToEffectivePixel( ndcP.y ) );
+		}
+		
+		//	numerically invert this->applyLensDistortion
+		Vector2 removeLensDistortion( const Vector2 &q ) const throw( ynxValueException );
+		
+		//	get upper bound of the difference of warp offsets of this and %other% 
+		//		over the whole image ( in [0,1] like this->applyWarp ), both must be
+		//		precomputed. HUGE_VAL when lens distortions differ
+		double computeMaxWarpOffsetDifference( const RollingShutterLensDistortionEngine &other ) const;
 
 	//---------------------------------------------------------------------
 	//	public operator overloads
@@ -0,0 +1,316 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "ScanlineWarpStream.h"
+
+//	conversion between image space and engine space
+#include "PointNormalization.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScanlineWarpStream MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScanlineWarpStream STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScanlineWarpStream MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+//	%engine% must be precomputed
+ScanlineWarpStream::ScanlineWarpStream( const RollingShutterLensDistortionEngine &engine, 
+										bool isUndistort, 
+										int width, int height, int numChannels ) :
+		engine( engine ),
+		isUndistort( isUndistort ),
+		width( width ), height( height ), numChannels( numChannels ),
+		windowSize( 0 ),
+		numRowsPushed( 0 ), numRowsPopped( 0 ),
+		nextRowSourcePositions( width ),
+		nextRowIsWarped( new bool[width] ),
+		nextRowMinSourceRow( -1 ), nextRowMaxSourceRow( -1 ),
+		isNextRowComputed( false )
+{
+	assert( width > 0 && height > 0 && numChannels > 0 );
+	
+	//	an output row samples source rows up to the maximum displacement above
+	//		and below it, and the rows pushed are ahead of the rows popped by 
+	//		the displacement again, plus a row each side for interpolation
+	int maxDisplacement = int( ceil( this->estimateMaxVerticalDisplacement() ) );
+	this->resizeWindow( std::min( 2 * maxDisplacement + 4, height ) );
+}
+ScanlineWarpStream::~ScanlineWarpStream()
+{
+	
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	give next source row ( width * numChannels floats )
+//	THROWS ynxValueException if every row was already given
+void ScanlineWarpStream::pushSourceRow( const float *sourceRow ) throw( ynxValueException )
+{
+	if( this->numRowsPushed == this->height )
+		throw ynxValueException( "ScanlineWarpStream::pushSourceRow() : every source row was already given!" );
+	
+	//	the row this one replaces must not be needed by the next output row,
+	//		otherwise the displacement estimate was too small so grow the window
+	if( !this->isDone() )
+	{
+		this->computeNextRow();
+		int replacedRow = this->numRowsPushed - this->windowSize;
+		if( replacedRow >= 0 && replacedRow >= this->nextRowMinSourceRow )
+			this->resizeWindow( this->windowSize * 2 );
+	}
+	
+	//	store row
+	size_t rowLength = size_t( this->width ) * this->numChannels;
+	std::copy( sourceRow, sourceRow + rowLength, 
+				this->window.begin() + size_t( this->numRowsPushed % this->windowSize ) * rowLength );
+	this->numRowsPushed ++;
+}
+
+//	check if next output row can be emitted
+bool ScanlineWarpStream::isOutputRowReady()
+{
+	if( this->isDone() )
+		return false;
+	
+	//	ready once every source row it samples from is given
+	this->computeNextRow();
+	return this->numRowsPushed == this->height || 
+			this->numRowsPushed > this->nextRowMaxSourceRow;
+}
+
+//	emit next output row into %outputRow_ret% ( width * numChannels floats )
+//	THROWS ynxValueException if the row isn't ready
+void ScanlineWarpStream::popOutputRow( float *outputRow_ret ) throw( ynxValueException )
+{
+	if( !this->isOutputRowReady() )
+		throw ynxValueException( "ScanlineWarpStream::popOutputRow() : output row isn't ready!" );
+	
+	//	rows which are still in the window
+	int firstRow = std::max( this->numRowsPushed - this->windowSize, 0 ),
+		lastRow = this->numRowsPushed - 1;
+	
+	for( int x = 0 ; x < this->width ; x++ )
+	{
+		float *outputPixel = outputRow_ret + size_t( x ) * this->numChannels;
+		std::fill( outputPixel, outputPixel + this->numChannels, 0.0f );
+		if( !this->nextRowIsWarped[x] )
+			continue;
+		
+		//	pixel centers are at integer positions in the same way the node
+		//		samples at the warped position + 0.5
+		const Vector2 &sourcePosition = this->nextRowSourcePositions[x];
+		int sourceX = int( floor( sourcePosition.x ) ),
+			sourceY = int( floor( sourcePosition.y ) );
+		float fx = float( sourcePosition.x - sourceX ),
+				fy = float( sourcePosition.y - sourceY );
+		
+		//	bilinearly interpolate the four surrounding source pixels,
+		//		black outside of the image
+		for( int j = 0 ; j < 2 ; j++ )
+		{
+			int y = sourceY + j;
+			if( y < firstRow || y > lastRow )
+				continue;
+			
+			const float *sourceRow = this->getSourceRow( y );
+			float weightY = j ? fy : 1 - fy;
+			for( int i = 0 ; i < 2 ; i++ )
+			{
+				int sx = sourceX + i;
+				if( sx < 0 || sx >= this->width )
+					continue;
+				
+				float weight = weightY * ( i ? fx : 1 - fx );
+				const float *sourcePixel = sourceRow + size_t( sx ) * this->numChannels;
+				for( int c = 0 ; c < this->numChannels ; c++ )
+					outputPixel[c] += weight * sourcePixel[c];
+			}
+		}
+	}
+	
+	//	move on to next output row
+	this->numRowsPopped ++;
+	this->isNextRowComputed = false;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	warp output pixels (x,%y%) of a row to their source positions
+void ScanlineWarpStream::computeRowSourcePositions( double y, Vector2 *sourcePositions_ret, bool *isWarped_ret ) const
+{
+	//	normalize output positions
+	for( int x = 0 ; x < this->width ; x++ )
+	{
+		::normalizePoint( Vector2( x, y ), this->width, this->height, 1, &sourcePositions_ret[x] );
+		isWarped_ret[x] = true;
+	}
+	
+	//	warp the whole row
+	if( this->isUndistort )
+		this->engine.removeWarpSpan( sourcePositions_ret, this->width, sourcePositions_ret, isWarped_ret );
+	else
+	{
+		for( int x = 0 ; x < this->width ; x++ )
+		{
+			try
+			{
+				sourcePositions_ret[x] = this->engine.applyWarp( sourcePositions_ret[x] );
+			}
+			catch( ynxValueException &e )
+			{
+				isWarped_ret[x] = false;
+			}
+		}
+	}
+	
+	//	unnormalize source positions
+	for( int x = 0 ; x < this->width ; x++ )
+	{
+		Vector2 normalizedSourcePosition( sourcePositions_ret[x] );
+		::unnormalizePoint( normalizedSourcePosition, this->width, this->height, 1, &sourcePositions_ret[x] );
+	}
+}
+
+//	estimate maximum vertical displacement of the warp ( in pixel )
+double ScanlineWarpStream::estimateMaxVerticalDisplacement() const
+{
+	const int NUM_SAMPLES = SCANLINE_WARP_STREAM_NUM_DISPLACEMENT_SAMPLES;
+	
+	//	warp whole rows at sampled heights and keep every NUM_SAMPLES'th pixel
+	std::vector<Vector2> sourcePositions( this->width );
+	std::unique_ptr<bool[]> isWarped( new bool[this->width] );
+	int stepX = std::max( this->width / ( NUM_SAMPLES - 1 ), 1 );
+	double maxDisplacement = 0;
+	for( int j = 0 ; j < NUM_SAMPLES ; j++ )
+	{
+		double y = double( this->height - 1 ) * j / ( NUM_SAMPLES - 1 );
+		this->computeRowSourcePositions( y, sourcePositions.data(), isWarped.get() );
+		for( int x = 0 ; x < this->width ; x += stepX )
+		{
+			if( isWarped[x] )
+				maxDisplacement = std::max( maxDisplacement, fabs( sourcePositions[x].y - y ) );
+		}
+	}
+	
+	return maxDisplacement;
+}
+
+//	compute source positions of the next output row and the range of
+//		source rows they sample from
+void ScanlineWarpStream::computeNextRow()
+{
+	if( this->isNextRowComputed )
+		return;
+	
+	this->computeRowSourcePositions( this->numRowsPopped, 
+									this->nextRowSourcePositions.data(), 
+									this->nextRowIsWarped.get() );
+	
+	//	rows of both bilinear neighbours, clamped to the image
+	int minRow = this->height, maxRow = -1;
+	for( int x = 0 ; x < this->width ; x++ )
+	{
+		if( !this->nextRowIsWarped[x] )
+			continue;
+		
+		int sourceY = int( floor( this->nextRowSourcePositions[x].y ) );
+		minRow = std::min( minRow, sourceY );
+		maxRow = std::max( maxRow, sourceY + 1 );
+	}
+	this->nextRowMinSourceRow = std::max( minRow, 0 );
+	this->nextRowMaxSourceRow = std::min( maxRow, this->height - 1 );
+	this->isNextRowComputed = true;
+}
+
+//	resize ring buffer to %windowSize% rows keeping every row in it
+void ScanlineWarpStream::resizeWindow( int windowSize )
+{
+	windowSize = std::max( std::min( windowSize, this->height ), 1 );
+	size_t rowLength = size_t( this->width ) * this->numChannels;
+	std::vector<float> window( size_t( windowSize ) * rowLength );
+	
+	//	copy rows which are in both the old and the new window
+	int firstRow = std::max( this->numRowsPushed - std::min( this->windowSize, windowSize ), 0 );
+	for( int y = firstRow ; y < this->numRowsPushed ; y++ )
+		std::copy( this->getSourceRow( y ), this->getSourceRow( y ) + rowLength, 
+					window.begin() + size_t( y % windowSize ) * rowLength );
+	
+	this->window.swap( window );
+	this->windowSize = windowSize;
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS ScanlineWarpStream MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___ScanlineWarpStream_h)
+#define ___ScanlineWarpStream_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <vector>
+#include <memory>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	number of samples per edge used to estimate maximum vertical displacement
+#define SCANLINE_WARP_STREAM_NUM_DISPLACEMENT_SAMPLES 17
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class ScanlineWarpStream
+//
+//---------------------------------------------------------------------
+
+//	warp an image which is given one source scanline at a time, in order
+//		from row 0, and emit each output scanline as soon as all source 
+//		rows it samples from have been given. Only a sliding window of 
+//		source rows is kept, sized from the maximum vertical displacement 
+//		of the warp, so memory is O( window ) rather than O( height ).
+//	Rows are interleaved floats ( width * numChannels ), pixel (x,y) uses the
+//		same image space as the nuke node, source pixels are bilinearly 
+//		interpolated and positions that can't be warped are black.
+//
+//	usage :
+//		for each source row
+//			while( stream.isOutputRowReady() )
+//				stream.popOutputRow( outputRow );
+//			stream.pushSourceRow( sourceRow );
+//		while( stream.isOutputRowReady() )
+//			stream.popOutputRow( outputRow );
+class ScanlineWarpStream
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	warp to stream ( a copy, precomputed )
+		RollingShutterLensDistortionEngine engine;
+		
+		//	remove the warp instead of applying it
+		bool isUndistort;
+		
+		//	image size and number of channels per pixel
+		int width, height, numChannels;
+		
+		//	ring buffer of the last this->windowSize source rows, source row
+		//		y is stored in slot y % this->windowSize
+		int windowSize;
+		std::vector<float> window;
+		
+		//	number of source rows given and output rows emitted
+		int numRowsPushed, numRowsPopped;
+		
+		//	source positions of next output row, whether each is warped, and 
+		//		range of source rows they sample from ( -1 when not computed yet )
+		std::vector<Vector2> nextRowSourcePositions;
+		std::unique_ptr<bool[]> nextRowIsWarped;
+		int nextRowMinSourceRow, nextRowMaxSourceRow;
+		bool isNextRowComputed;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		//	%engine% must be precomputed
+		ScanlineWarpStream( const RollingShutterLensDistortionEngine &engine, 
+							bool isUndistort, 
+							int width, int height, int numChannels );
+		
+		~ScanlineWarpStream();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	get number of source rows kept ( grows only if the displacement
+		//		estimate was too small )
+		int getWindowSize() const
+		{	return this->windowSize;	}
+		
+		//	get number of source rows given and output rows emitted
+		int getNumRowsPushed() const
+		{	return this->numRowsPushed;	}
+		int getNumRowsPopped() const
+		{	return this->numRowsPopped;	}
+		
+		//	check if every output row has been emitted
+		bool isDone() const
+		{	return this->numRowsPopped == this->height;	}
+		
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	give next source row ( width * numChannels floats )
+		//	THROWS ynxValueException if every row was already given
+		void pushSourceRow( const float *sourceRow ) throw( ynxValueException );
+		
+		//	check if next output row can be emitted
+		bool isOutputRowReady();
+		
+		//	emit next output row into %outputRow_ret% ( width * numChannels floats )
+		//	THROWS ynxValueException if the row isn't ready
+		void popOutputRow( float *outputRow_ret ) throw( ynxValueException );
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	warp output pixels (x,%y%) of a row to their source positions
+		void computeRowSourcePositions( double y, Vector2 *sourcePositions_ret, bool *isWarped_ret ) const;
+		
+		//	estimate maximum vertical displacement of the warp ( in pixel )
+		double estimateMaxVerticalDisplacement() const;
+		
+		//	compute source positions of the next output row and the range of
+		//		source rows they sample from
+		void computeNextRow();
+		
+		//	resize ring buffer to %windowSize% rows keeping every row in it
+		void resizeWindow( int windowSize );
+		
+		//	get stored source row %y%
+		const float *getSourceRow( int y ) const
+		{	return &this->window[size_t( y % this->windowSize ) * this->width * this->numChannels];	}
+	
+};
+//---------------------------------------------------------------------
+//	END class ScanlineWarpStream
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <stdlib.h>
+#include <new>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "ScratchArena.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	round %numBytes% up to a multiple of SCRATCH_ARENA_ALIGNMENT
+static inline size_t alignSize( size_t numBytes )
+{
+	return ( numBytes + SCRATCH_ARENA_ALIGNMENT - 1 ) & ~size_t( SCRATCH_ARENA_ALIGNMENT - 1 );
+}
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScratchArena MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScratchArena STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//	get arena of calling thread
+ScratchArena &ScratchArena::getThreadInstance()
+{
+	static thread_local ScratchArena threadArena;
+	return threadArena;
+}
+
+//---------------------------------------------------------------------
+//
+//	CLASS ScratchArena MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+ScratchArena::ScratchArena()
+{
+	this->reset();
+}
+ScratchArena::~ScratchArena()
+{
+	for( size_t i = 0 ; i < this->blocks.size() ; i++ )
+		free( this->blocks[i] );
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+//	get total size of all blocks ( in bytes )
+size_t ScratchArena::getCapacity() const
+{
+	size_t capacity = 0;
+	for( size_t i = 0 ; i < this->blockSizes.size() ; i++ )
+		capacity += this->blockSizes[i];
+	return capacity;
+}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	allocate %numBytes% aligned to SCRATCH_ARENA_ALIGNMENT, valid 
+//		until the arena is rewound past it
+void *ScratchArena::allocate( size_t numBytes )
+{
+	numBytes = alignSize( numBytes );
+	
+	//	move on to the next block which has room, a block which is 
+	//		too small is skipped until the arena is rewound
+	while( this->current.blockIndex < this->blocks.size() && 
+			this->current.offset + numBytes > this->blockSizes[this->current.blockIndex] )
+	{
+		this->current.blockIndex ++;
+		this->current.offset = 0;
+	}
+	
+	//	grow only when no block has room
+	if( this->current.blockIndex == this->blocks.size() )
+		this->addBlock( numBytes );
+	
+	char *p = this->blocks[this->current.blockIndex] + this->current.offset;
+	this->current.offset += numBytes;
+	return p;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	add a block of at least %numBytes% after the last block
+void ScratchArena::addBlock( size_t numBytes )
+{
+	//	next size class is at least twice the last block, so the number of 
+	//		blocks stays logarithmic in the largest row
+	size_t blockSize = SCRATCH_ARENA_MIN_BLOCK_SIZE;
+	if( !this->blockSizes.empty() )
+		blockSize = this->blockSizes.back() * 2;
+	while( blockSize < numBytes )
+		blockSize *= 2;
+	
+	void *block = NULL;
+	if( posix_memalign( &block, SCRATCH_ARENA_ALIGNMENT, blockSize ) != 0 )
+		throw std::bad_alloc();
+	
+	this->blocks.push_back( static_cast<char *>( block ) );
+	this->blockSizes.push_back( blockSize );
+	assert( this->blocks.size() == this->current.blockIndex + 1 );
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS ScratchArena MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,197 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___ScratchArena_h)
+#define ___ScratchArena_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <vector>
+#include <stddef.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	alignment of every scratch allocation ( a cache line, enough for any SIMD type )
+#define SCRATCH_ARENA_ALIGNMENT 64
+
+//	size of the smallest block, blocks are this size times a power of two
+#define SCRATCH_ARENA_MIN_BLOCK_SIZE ( 64 * 1024 )
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class ScratchArena
+//
+//---------------------------------------------------------------------
+
+//	bump allocator for transient per row buffers. Memory is taken from blocks
+//		in power of two size classes which are kept when the arena is rewound,
+//		so once the arena has grown to the largest row nothing is allocated
+//		or freed. Every thread has its own arena ( getThreadInstance ), so
+//		there is no locking and no allocator contention.
+class ScratchArena
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+	
+		//	position in the arena to rewind to
+		class Marker
+		{
+			public:
+				size_t blockIndex, offset;
+		};
+		
+		//	rewind the arena to where it was when the scope started,
+		//		scopes may nest ( e.g. an upstream node rendering on the 
+		//		same thread while this node's buffers are still in use )
+		class Scope
+		{
+			protected:
+				ScratchArena &arena;
+				Marker marker;
+				
+			public:
+				Scope( ScratchArena &arena ) : arena( arena ), marker( arena.getMarker() )
+				{
+				}
+				~Scope()
+				{
+					this->arena.rewind( this->marker );
+				}
+				
+			private:
+				Scope( const Scope & );
+				Scope &operator=( const Scope & );
+		};
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	blocks and their sizes, every block is SCRATCH_ARENA_ALIGNMENT aligned
+		std::vector<char *> blocks;
+		std::vector<size_t> blockSizes;
+		
+		//	block being allocated from and offset of next allocation in it
+		Marker current;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		ScratchArena();
+		
+		~ScratchArena();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	get arena of calling thread
+		static ScratchArena &getThreadInstance();
+		
+		//	get current position to rewind to
+		Marker getMarker() const
+		{	return this->current;	}
+		
+		//	get total size of all blocks ( in bytes )
+		size_t getCapacity() const;
+		
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	allocate %numBytes% aligned to SCRATCH_ARENA_ALIGNMENT, valid 
+		//		until the arena is rewound past it
+		void *allocate( size_t numBytes );
+		
+		//	allocate an array of %count% T, nothing is constructed so T
+		//		must be a plain type which is written before it is read
+		template< class T >
+		T *allocate( size_t count )
+		{	return static_cast<T *>( this->allocate( count * sizeof( T ) ) );	}
+		
+		//	free everything allocated after %marker%, blocks are kept
+		void rewind( const Marker &marker )
+		{	this->current = marker;	}
+		
+		//	free everything, blocks are kept
+		void reset()
+		{	this->current.blockIndex = this->current.offset = 0;	}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	add a block of at least %numBytes% after the last block
+		void addBlock( size_t numBytes );
+	
+	//---------------------------------------------------------------------
+	//	private member functions
+	//---------------------------------------------------------------------
+	private:
+		ScratchArena( const ScratchArena & );
+		ScratchArena &operator=( const ScratchArena & );
+	
+};
+//---------------------------------------------------------------------
+//	END class ScratchArena
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,263 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "WarmStartCache.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	get 1 / smallest singular value of the jacobian of the warp of %engine%
+//		at %p%, HUGE_VAL where the warp is singular
+static inline double computeInverseStretch( const RollingShutterLensDistortionEngine &engine, const Vector2 &p )
+{
+	Vector2 partialX, partialY;
+	engine.computeWarpJacobian( p, &partialX, &partialY );
+	double frobeniusSquare = partialX.sqrnorm() + partialY.sqrnorm(),
+			determinant = partialX.x * partialY.y - partialX.y * partialY.x;
+	double smallestSquare = ( frobeniusSquare - sqrt( std::max( 0., frobeniusSquare * frobeniusSquare - 
+																	4 * determinant * determinant ) ) ) / 2;
+	return smallestSquare > 0 ? 1 / sqrt( smallestSquare ) : HUGE_VAL;
+}
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarmStartInverse MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//	solve grid over [x,r]x[y,t] ( in [0,1] ) with a node every %spacing% 
+//		for %engine%, starting from %previous% where it covers a node
+void WarmStartInverse::compute( const RollingShutterLensDistortionEngine &engine, 
+								double x, double y, double r, double t, double spacing,
+								const WarmStartInverse *previous /*= NULL*/ )
+{
+	this->engine = engine;
+	this->grid.resize( x, y, r, t, spacing );
+	this->maxInverseStretch = 0;
+	
+	//	solve one row of nodes at a time
+	int numNodesX = this->grid.getNumNodesX();
+	std::vector<Vector2> q( numNodesX ), initialGuesses( numNodesX ), p( numNodesX );
+	std::unique_ptr<bool[]> isSolved( new bool[numNodesX] );
+	for( int j = 0 ; j < this->grid.getNumNodesY() ; j++ )
+	{
+		for( int i = 0 ; i < numNodesX ; i++ )
+		{
+			q[i] = this->grid.getNodePosition( i, j );
+			isSolved[i] = true;
+			
+			//	previous frame's solution, else the usual prediction
+			if( previous == NULL || !previous->grid.interpolate( q[i], &initialGuesses[i] ) )
+				initialGuesses[i] = engine.predictRemoveWarp( q[i] );
+		}
+		
+		engine.removeWarpSpan( q.data(), numNodesX, p.data(), isSolved.get(), initialGuesses.data() );
+		
+		for( int i = 0 ; i < numNodesX ; i++ )
+		{
+			this->grid.setNodeValue( i, j, p[i], isSolved[i] );
+			if( isSolved[i] )
+				this->maxInverseStretch = std::max( this->maxInverseStretch, ::computeInverseStretch( engine, p[i] ) );
+		}
+	}
+	
+	//	measure interpolation error against solving
+	this->maxInterpolationError = this->measureMaxError( engine, &this->maxInverseStretch );
+	
+	//	keep the grid compact, interpolated values are then off by up to
+	//		the encoding error more
+	this->grid.compact();
+	this->maxInterpolationError += this->grid.getMaxEncodingError();
+}
+
+//	measure the error of interpolating the grid against solving with %engine%
+//		at cell centers of every WARM_START_ERROR_SAMPLE_ROW_STRIDE'th row of
+//		cells ( in [0,1] like the engine ). If %maxInverseStretch_ret% is given
+//		it is raised to the inverse stretch of %engine% at the solutions
+double WarmStartInverse::measureMaxError( const RollingShutterLensDistortionEngine &engine, 
+											double *maxInverseStretch_ret /*= NULL*/ ) const
+{
+	int numCells = this->grid.getNumNodesX() - 1;
+	double spacing = this->grid.getSpacing(),
+			maxError = 0;
+	if( numCells <= 0 )
+		return maxError;
+	
+	std::vector<Vector2> q( numCells ), interpolatedP( numCells ), p( numCells );
+	std::unique_ptr<bool[]> isSolved( new bool[numCells] );
+	for( int j = 0 ; j < this->grid.getNumNodesY() - 1 ; j += WARM_START_ERROR_SAMPLE_ROW_STRIDE )
+	{
+		for( int i = 0 ; i < numCells ; i++ )
+		{
+			q[i] = this->grid.getNodePosition( i, j ) + Vector2( spacing / 2, spacing / 2 );
+			isSolved[i] = this->grid.interpolate( q[i], &interpolatedP[i] );
+		}
+		
+		engine.removeWarpSpan( q.data(), numCells, p.data(), isSolved.get(), interpolatedP.data() );
+		
+		for( int i = 0 ; i < numCells ; i++ )
+		{
+			if( !isSolved[i] )
+				continue;
+			maxError = std::max( maxError, sqrt( ( p[i] - interpolatedP[i] ).sqrnorm() ) );
+			if( maxInverseStretch_ret )
+				*maxInverseStretch_ret = std::max( *maxInverseStretch_ret, ::computeInverseStretch( engine, p[i] ) );
+		}
+	}
+	
+	return maxError;
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS WarmStartInverse MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarmStartCache MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarmStartCache STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarmStartCache MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+WarmStartCache::WarmStartCache()
+{
+	
+}
+WarmStartCache::~WarmStartCache()
+{
+	
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+//	get the process wide store
+WarmStartCache &WarmStartCache::getInstance()
+{
+	//	constructed on first use ( thread safe in c++11 )
+	static WarmStartCache sInstance;
+	return sInstance;
+}
+
+//	get memory used by all entries ( in bytes )
+size_t WarmStartCache::getMemoryUsage()
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	
+	size_t memoryUsage = 0;
+	for( std::unordered_map<std::string, std::shared_ptr<const WarmStartInverse> >::iterator it = this->entries.begin() ;
+			it != this->entries.end() ; ++it )
+		memoryUsage += it->second->getMemorySize();
+	return memoryUsage;
+}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	find last inverse of %key%
+//	returns an empty pointer if there is none
+std::shared_ptr<const WarmStartInverse> WarmStartCache::find( const std::string &key )
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	
+	std::unordered_map<std::string, std::shared_ptr<const WarmStartInverse> >::iterator it = this->entries.find( key );
+	if( it == this->entries.end() )
+		return std::shared_ptr<const WarmStartInverse>();
+	return it->second;
+}
+
+//	replace last inverse of %key%
+//	NOTE users still holding the replaced inverse keep it alive
+void WarmStartCache::insert( const std::string &key, const std::shared_ptr<const WarmStartInverse> &warmStartInverse )
+{
+	assert( warmStartInverse );
+	
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->entries[key] = warmStartInverse;
+}
+
+//	remove inverse of %key%, or all inverses
+void WarmStartCache::erase( const std::string &key )
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->entries.erase( key );
+}
+void WarmStartCache::clear()
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->entries.clear();
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	END CLASS WarmStartCache MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___WarmStartCache_h)
+#define ___WarmStartCache_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+#include "WarpGrid.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	interpolation error of a WarmStartInverse is measured at the center
+//		of every cell in every this many rows of cells
+#define WARM_START_ERROR_SAMPLE_ROW_STRIDE 4
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class WarmStartInverse
+//
+//---------------------------------------------------------------------
+
+//	grid of removeWarp solutions of one frame, kept to start the solves
+//		of the next frame close to their answers, or to be used as is when
+//		the next frame's warp is close enough
+class WarmStartInverse
+{
+	public:
+		//	engine with precomputed values the grid was solved for
+		RollingShutterLensDistortionEngine engine;
+		
+		//	removeWarp solutions in [0,1] like the engine
+		WarpGrid grid;
+		
+		//	maximum error of interpolating the grid against solving, including
+		//		the encoding error of the compacted grid ( in [0,1] like the engine )
+		double maxInterpolationError;
+		
+		//	maximum stretch of removeWarp, 1 / smallest singular value of the jacobian
+		//		of the warp, over the grid ( HUGE_VAL where the warp folds ). A warp
+		//		offset difference maps to up to this times as much in the inverse
+		double maxInverseStretch;
+		
+	public:
+		//contructors/destructors
+		WarmStartInverse() : maxInterpolationError( 0 ), maxInverseStretch( 1 )
+		{
+		}
+		
+	public:
+		//	solve grid over [x,r]x[y,t] ( in [0,1] ) with a node every %spacing% 
+		//		for %engine%, starting from %previous% where it covers a node
+		void compute( const RollingShutterLensDistortionEngine &engine, 
+						double x, double y, double r, double t, double spacing,
+						const WarmStartInverse *previous = NULL );
+		
+		//	measure the error of interpolating the grid against solving with %engine%
+		//		at a sample of positions ( in [0,1] like the engine ). If
+		//		%maxInverseStretch_ret% is given it is raised to the inverse stretch
+		//		of %engine% at the solutions
+		double measureMaxError( const RollingShutterLensDistortionEngine &engine, 
+								double *maxInverseStretch_ret = NULL ) const;
+		
+		//	get approximate memory used by this object ( in bytes )
+		size_t getMemorySize() const
+		{	return sizeof( WarmStartInverse ) + this->grid.getMemorySize();	}
+};
+//---------------------------------------------------------------------
+//	END class WarmStartInverse
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class WarmStartCache
+//
+//---------------------------------------------------------------------
+
+//	process wide store of the last WarmStartInverse of every node, keyed 
+//		by node name ( and view ), so the next frame rendered by any op of
+//		the node can start from it
+class WarmStartCache
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	guard for all member data below
+		std::mutex mutex;
+		
+		//	last inverse of every key
+		std::unordered_map<std::string, std::shared_ptr<const WarmStartInverse> > entries;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		WarmStartCache();
+		
+		~WarmStartCache();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	get the process wide store
+		static WarmStartCache &getInstance();
+		
+		//	get memory used by all entries ( in bytes )
+		size_t getMemoryUsage();
+			
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	find last inverse of %key%
+		//	returns an empty pointer if there is none
+		std::shared_ptr<const WarmStartInverse> find( const std::string &key );
+		
+		//	replace last inverse of %key%
+		//	NOTE users still holding the replaced inverse keep it alive
+		void insert( const std::string &key, const std::shared_ptr<const WarmStartInverse> &warmStartInverse );
+		
+		//	remove inverse of %key%, or all inverses
+		void erase( const std::string &key );
+		void clear();
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+};
+//---------------------------------------------------------------------
+//	END class WarmStartCache
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "WarpDataCache.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpDataCache MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpDataCache STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpDataCache MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+WarpDataCache::WarpDataCache() : memoryUsage( 0 )
+{
+	//	get memory limit from environment or use default
+	long memoryLimitMB = DEFAULT_WARP_DATA_CACHE_MEMORY_LIMIT_MB;
+	const char *memoryLimitEnv = getenv( WARP_DATA_CACHE_MEMORY_LIMIT_ENV );
+	if( memoryLimitEnv != NULL && atol( memoryLimitEnv ) >= 0 )
+		memoryLimitMB = atol( memoryLimitEnv );
+	this->memoryLimit = size_t( memoryLimitMB ) * 1024 * 1024;
+}
+WarpDataCache::~WarpDataCache()
+{
+	
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+//	get the process wide cache
+WarpDataCache &WarpDataCache::getInstance()
+{
+	//	constructed on first use ( thread safe in c++11 )
+	static WarpDataCache sInstance;
+	return sInstance;
+}
+
+//	get/set maximum memory used by the cache ( in bytes )
+size_t WarpDataCache::getMemoryLimit()
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	return this->memoryLimit;
+}
+void WarpDataCache::setMemoryLimit( size_t value )
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->memoryLimit = value;
+	this->evict();
+}
+
+//	get memory used by the cache ( in bytes )
+size_t WarpDataCache::getMemoryUsage()
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	return this->memoryUsage;
+}
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	find data for %key% and mark it most recently used
+//	returns an empty pointer if there is no data for %key%
+std::shared_ptr<const WarpData> WarpDataCache::find( uint64_t key )
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	
+	std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it = this->entryIndex.find( key );
+	if( it == this->entryIndex.end() )
+		return std::shared_ptr<const WarpData>();
+	
+	//	move to front
+	this->entries.splice( this->entries.begin(), this->entries, it->second );
+	return it->second->second;
+}
+
+//	insert data for %key%, replacing any existing data, then evict
+//		least recently used data until within the memory limit
+//	NOTE users still holding evicted data keep it alive
+void WarpDataCache::insert( uint64_t key, const std::shared_ptr<const WarpData> &warpData )
+{
+	assert( warpData );
+	
+	std::lock_guard<std::mutex> lock( this->mutex );
+	
+	//	remove existing data
+	std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it = this->entryIndex.find( key );
+	if( it != this->entryIndex.end() )
+	{
+		this->memoryUsage -= it->second->second->getMemorySize();
+		this->entries.erase( it->second );
+		this->entryIndex.erase( it );
+	}
+	
+	//	add as most recently used
+	this->entries.push_front( Entry( key, warpData ) );
+	this->entryIndex[key] = this->entries.begin();
+	this->memoryUsage += warpData->getMemorySize();
+	
+	this->evict();
+}
+
+//	remove all data
+void WarpDataCache::clear()
+{
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->entries.clear();
+	this->entryIndex.clear();
+	this->memoryUsage = 0;
+}
+
+//	combine %value% into %key% ( to build keys from parameters )
+uint64_t WarpDataCache::combineKey( uint64_t key, uint64_t value )
+{
+	//	same mixing as boost::hash_combine extended to 64 bit
+	return key ^ ( value + 0x9e3779b97f4a7c15ULL + ( key << 6 ) + ( key >> 2 ) );
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	evict least recently used entries until within memory limit
+//	NOTE this->mutex must be locked
+void WarpDataCache::evict()
+{
+	while( this->memoryUsage > this->memoryLimit && !this->entries.empty() )
+	{
+		const Entry &leastRecentlyUsed = this->entries.back();
+		this->memoryUsage -= leastRecentlyUsed.second->getMemorySize();
+		this->entryIndex.erase( leastRecentlyUsed.first );
+		this->entries.pop_back();
+	}
+}
+
+//---------------------------------------------------------------------
+//
+//	END CLASS WarpDataCache MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
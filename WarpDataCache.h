@@ -0,0 +1,206 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___WarpDataCache_h)
+#define ___WarpDataCache_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+#include "WarpGrid.h"
+#include "InvertibilityDomain.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//	default memory limit of the process wide warp data cache ( in MB ),
+//		can be overridden with the environment variable below
+#define DEFAULT_WARP_DATA_CACHE_MEMORY_LIMIT_MB 256
+#define WARP_DATA_CACHE_MEMORY_LIMIT_ENV "YNX_WARP_DATA_CACHE_MB"
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class WarpData
+//
+//---------------------------------------------------------------------
+
+//	warp data computed once for a set of parameters and shared
+//		read only by every user with the same parameters
+class WarpData
+{
+	public:
+		//	engine with precomputed values
+		RollingShutterLensDistortionEngine engine;
+		
+		//	bounding box of the warped input ( x, y, r, t in pixel )
+		int boundingBox[4];
+		
+		//	coarse grid of source positions ( empty when not needed )
+		WarpGrid coarseWarpGrid;
+		
+		//	region where the warp can be removed ( everywhere when not needed )
+		InvertibilityDomain invertibilityDomain;
+		
+	public:
+		//contructors/destructors
+		WarpData()
+		{
+			this->boundingBox[0] = this->boundingBox[1] = this->boundingBox[2] = this->boundingBox[3] = 0;
+		}
+		
+	public:
+		//	get approximate memory used by this object ( in bytes )
+		size_t getMemorySize() const
+		{	return sizeof( WarpData ) + this->coarseWarpGrid.getMemorySize() + this->invertibilityDomain.getMemorySize();	}
+};
+//---------------------------------------------------------------------
+//	END class WarpData
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class WarpDataCache
+//
+//---------------------------------------------------------------------
+
+//	process wide least recently used cache of WarpData keyed by a
+//		hash of everything the data depends on
+class WarpDataCache
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	guard for all member data below
+		std::mutex mutex;
+		
+		//	entries from most to least recently used, and index of
+		//		entries by key
+		typedef std::pair<uint64_t, std::shared_ptr<const WarpData> > Entry;
+		std::list<Entry> entries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> entryIndex;
+		
+		//	memory used by all entries and maximum memory ( in bytes )
+		size_t memoryUsage, memoryLimit;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		WarpDataCache();
+		
+		~WarpDataCache();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	get the process wide cache
+		static WarpDataCache &getInstance();
+		
+		//	get/set maximum memory used by the cache ( in bytes )
+		size_t getMemoryLimit();
+		void setMemoryLimit( size_t value );
+		
+		//	get memory used by the cache ( in bytes )
+		size_t getMemoryUsage();
+			
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	find data for %key% and mark it most recently used
+		//	returns an empty pointer if there is no data for %key%
+		std::shared_ptr<const WarpData> find( uint64_t key );
+		
+		//	insert data for %key%, replacing any existing data, then evict
+		//		least recently used data until within the memory limit
+		//	NOTE users still holding evicted data keep it alive
+		void insert( uint64_t key, const std::shared_ptr<const WarpData> &warpData );
+		
+		//	remove all data
+		void clear();
+		
+		//	combine %value% into %key% ( to build keys from parameters )
+		static uint64_t combineKey( uint64_t key, uint64_t value );
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	evict least recently used entries until within memory limit
+		//	NOTE this->mutex must be locked
+		void evict();
+	
+};
+//---------------------------------------------------------------------
+//	END class WarpDataCache
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,211 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "WarpGrid.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpGrid MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpGrid STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS WarpGrid MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+WarpGrid::WarpGrid() : originX( 0 ), originY( 0 ), spacing( 1 ), numNodesX( 0 ), numNodesY( 0 )
+{
+	
+}
+WarpGrid::~WarpGrid()
+{
+	
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	resize grid to cover [x,r]x[y,t] with a node every %spacing%, all
+//		nodes are invalid until set
+void WarpGrid::resize( double x, double y, double r, double t, double spacing )
+{
+	assert( spacing > 0 );
+	
+	this->originX = x;
+	this->originY = y;
+	this->spacing = spacing;
+	
+	//	always have a node on or beyond the right/top edge
+	this->numNodesX = int( ceil( ( r - x ) / spacing ) ) + 1;
+	this->numNodesY = int( ceil( ( t - y ) / spacing ) ) + 1;
+	
+	this->nodeValues.assign( this->numNodesX * this->numNodesY, Vector2() );
+	this->nodeValidFlags.assign( this->numNodesX * this->numNodesY, 0 );
+	this->nodeDisplacements.clear();
+}
+
+//	remove all nodes
+void WarpGrid::clear()
+{
+	this->numNodesX = this->numNodesY = 0;
+	this->nodeValues.clear();
+	this->nodeValidFlags.clear();
+	this->nodeDisplacements.clear();
+}
+
+//	replace node values by their displacements from the node positions
+//		encoded with one scale for the grid, a quarter of the memory
+void WarpGrid::compact()
+{
+	if( this->isCompact() || this->isEmpty() )
+		return;
+	
+	//	scale from the largest displacement of a valid node
+	double maxDisplacement = 0;
+	for( int j = 0 ; j < this->numNodesY ; j++ )
+	{
+		for( int i = 0 ; i < this->numNodesX ; i++ )
+		{
+			int index = j * this->numNodesX + i;
+			if( !this->nodeValidFlags[index] )
+				continue;
+			Vector2 displacement( this->nodeValues[index] - this->getNodePosition( i, j ) );
+			maxDisplacement = std::max( maxDisplacement, std::max( fabs( displacement.x ), fabs( displacement.y ) ) );
+		}
+	}
+	this->displacementEncoding.setMaxDisplacement( maxDisplacement );
+	
+	//	encode, invalid nodes are encoded too but never read
+	this->nodeDisplacements.resize( 2 * this->nodeValues.size() );
+	for( int j = 0 ; j < this->numNodesY ; j++ )
+	{
+		for( int i = 0 ; i < this->numNodesX ; i++ )
+		{
+			int index = j * this->numNodesX + i;
+			this->displacementEncoding.encode( this->getNodePosition( i, j ), this->nodeValues[index], 
+												&this->nodeDisplacements[2 * index] );
+		}
+	}
+	
+	//	release the positions
+	std::vector<Vector2>().swap( this->nodeValues );
+}
+
+//	bilinearly interpolate warped value at %p%
+//	returns false if %p% is outside the grid or any of
+//		the surrounding nodes is invalid
+bool WarpGrid::interpolate( const Vector2 &p, Vector2 *value_ret ) const
+{
+	//	position in grid cell units
+	double u = ( p.x - this->originX ) / this->spacing,
+			v = ( p.y - this->originY ) / this->spacing;
+	
+	//	nothing beyond the last row/column of nodes is extrapolated
+	if( u < 0 || v < 0 || u > this->numNodesX - 1 || v > this->numNodesY - 1 )
+		return false;
+	
+	//	get cell, the last row/column of nodes only bounds cells
+	int i = int( floor( u ) ),
+		j = int( floor( v ) );
+	if( i == this->numNodesX - 1 )
+		i --;
+	if( j == this->numNodesY - 1 )
+		j --;
+	if( i < 0 || j < 0 )
+		return false;
+	
+	//	all four corners must be valid
+	int index = j * this->numNodesX + i;
+	if( !this->nodeValidFlags[index] || !this->nodeValidFlags[index + 1] ||
+		!this->nodeValidFlags[index + this->numNodesX] || !this->nodeValidFlags[index + this->numNodesX + 1] )
+		return false;
+	
+	//	bilinear weights
+	double fu = u - i,
+			fv = v - j;
+	Vector2 v00 = this->getNodeValue( i, j ),
+			v10 = this->getNodeValue( i + 1, j ),
+			v01 = this->getNodeValue( i, j + 1 ),
+			v11 = this->getNodeValue( i + 1, j + 1 );
+	
+	value_ret->x = ( v00.x * ( 1 - fu ) + v10.x * fu ) * ( 1 - fv ) + 
+					( v01.x * ( 1 - fu ) + v11.x * fu ) * fv;
+	value_ret->y = ( v00.y * ( 1 - fu ) + v10.y * fu ) * ( 1 - fv ) + 
+					( v01.y * ( 1 - fu ) + v11.y * fu ) * fv;
+	
+	return true;
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	END CLASS WarpGrid MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___WarpGrid_h)
+#define ___WarpGrid_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <assert.h>
+#include <vector>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+#include "DisplacementEncoding.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	class WarpGrid
+//
+//---------------------------------------------------------------------
+
+//	coarse grid of warped positions which is bilinearly interpolated
+//		in between grid nodes. Values are filled in by the caller, so
+//		any warp ( apply, remove or a concatenated chain ) can be stored.
+//		Once filled the grid can be compacted to DisplacementEncoding
+//		displacements from the node positions, which are read only.
+class WarpGrid
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+	
+		//	position of the first grid node and distance between nodes
+		double originX, originY, spacing;
+		
+		//	number of grid nodes in x and y
+		int numNodesX, numNodesY;
+		
+		//	warped position and whether the warp succeeded for each node
+		//		( row major, x fastest ), the positions are empty once compacted
+		std::vector<Vector2> nodeValues;
+		std::vector<unsigned char> nodeValidFlags;
+		
+		//	encoded displacement of each node ( x and y ) once compacted
+		std::vector<int16_t> nodeDisplacements;
+		DisplacementEncoding displacementEncoding;
+	
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+	
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		WarpGrid();
+		
+		~WarpGrid();
+		
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	get number of grid nodes
+		int getNumNodesX() const
+		{	return this->numNodesX;	}
+		int getNumNodesY() const
+		{	return this->numNodesY;	}
+		
+		//	get distance between grid nodes
+		double getSpacing() const
+		{	return this->spacing;	}
+		
+		//	get position of grid node (i,j) in the grid domain
+		Vector2 getNodePosition( int i, int j ) const
+		{	return Vector2( this->originX + i * this->spacing, this->originY + j * this->spacing );	}
+		
+		//	get/set warped value of grid node (i,j)
+		//	NOTE a compacted grid can't be set
+		Vector2 getNodeValue( int i, int j ) const
+		{
+			int index = j * this->numNodesX + i;
+			if( this->isCompact() )
+				return this->displacementEncoding.decode( this->getNodePosition( i, j ), &this->nodeDisplacements[2 * index] );
+			return this->nodeValues[index];
+		}
+		bool isNodeValid( int i, int j ) const
+		{	return this->nodeValidFlags[j * this->numNodesX + i] != 0;	}
+		void setNodeValue( int i, int j, const Vector2 &value, bool isValid )
+		{
+			assert( !this->isCompact() );
+			this->nodeValues[j * this->numNodesX + i] = value;
+			this->nodeValidFlags[j * this->numNodesX + i] = isValid;
+		}
+		
+		//	check if the grid has no nodes
+		bool isEmpty() const
+		{	return this->nodeValidFlags.empty();	}
+		
+		//	check if node values are stored as encoded displacements
+		bool isCompact() const
+		{	return !this->nodeDisplacements.empty();	}
+		
+		//	get largest error of node values from compacting ( length, 0 if not compact )
+		double getMaxEncodingError() const
+		{	return this->isCompact() ? this->displacementEncoding.getMaxError() : 0;	}
+		
+		//	get memory used by grid nodes ( in bytes )
+		size_t getMemorySize() const
+		{
+			return this->nodeValues.size() * sizeof( Vector2 ) + 
+					this->nodeDisplacements.size() * sizeof( int16_t ) +
+					this->nodeValidFlags.size() * sizeof( unsigned char );
+		}
+			
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+	
+		//	resize grid to cover [x,r]x[y,t] with a node every %spacing%, all
+		//		nodes are invalid until set
+		void resize( double x, double y, double r, double t, double spacing );
+		
+		//	remove all nodes
+		void clear();
+		
+		//	replace node values by their displacements from the node positions
+		//		encoded with one scale for the grid, a quarter of the memory
+		void compact();
+		
+		//	bilinearly interpolate warped value at %p%
+		//	returns false if %p% is outside the grid or any of
+		//		the surrounding nodes is invalid
+		bool interpolate( const Vector2 &p, Vector2 *value_ret ) const;
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+	
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+	
+};
+//---------------------------------------------------------------------
+//	END class WarpGrid
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -0,0 +1,371 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "YnxDeepRollingShutterNode.h"
+
+//	conversion between image space and engine space
+#include "PointNormalization.h"
+
+//	knobs shared by every rolling shutter node
+#include "RollingShutterKnobs.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	number of output rows warped together, the deep source pixels of all
+//		of them are fetched from the input at once
+#define DEEP_ROW_BAND_HEIGHT 16
+
+//	number of bounding box samples per edge
+#define DEEP_NUM_BOUNDING_BOX_SAMPLES 32
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS YnxDeepRollingShutterNode MEMBER CLASSES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS YnxDeepRollingShutterNode STATIC MEMBERS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	CLASS YnxDeepRollingShutterNode MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+YnxDeepRollingShutterNode::YnxDeepRollingShutterNode( Node *node ) : DD::Image::DeepFilterOp( node )
+{
+	//	same defaults as YnxRollingShutterNode
+	this->rollingShutterLensDistortionEngine.setRollingShutterRatio( 0.0 );
+	this->rollingShutterLensDistortionEngine.setTopPointDepth( FARAWAYDEPTH );
+	this->rollingShutterLensDistortionEngine.setBottomPointDepth( FARAWAYDEPTH );
+	this->rollingShutterLensDistortionEngine.setTopLeftPrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+	this->rollingShutterLensDistortionEngine.setTopMiddlePrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+	this->rollingShutterLensDistortionEngine.setTopRightPrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+	this->rollingShutterLensDistortionEngine.setBottomLeftPrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+	this->rollingShutterLensDistortionEngine.setBottomMiddlePrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+	this->rollingShutterLensDistortionEngine.setBottomRightPrevNextPoint( Vector2( 0, 0 ), Vector2( 0, 0 ) );
+
+	//	set default for undistort
+	this->isUndistort = false;
+}
+YnxDeepRollingShutterNode::~YnxDeepRollingShutterNode()
+{
+
+}
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+
+//	This function is used for validate parameter value
+void YnxDeepRollingShutterNode::_validate( bool for_real )
+{
+	//	copy deep info from input
+	DD::Image::DeepFilterOp::_validate( for_real );
+
+	//	do nothing if there's no input
+	if( !this->input0() )
+	{ return; }
+
+	//	precompute the warp of this frame
+	this->rollingShutterLensDistortionEngine.precompute();
+
+	//	grow the bounding box to where the input's bounding box is warped to
+	DD::Image::Box boundingBox = this->_deepInfo.box();
+	boundingBox.merge( this->warpBoundingBox( this->_deepInfo.box(), false ) );
+	this->_deepInfo = DD::Image::DeepInfo( this->_deepInfo.formats(), boundingBox, this->_deepInfo.channels() );
+}
+
+//	This function is used for request the region of the input deep image
+//		needed to compute %box%
+void YnxDeepRollingShutterNode::getDeepRequests( DD::Image::Box box, const DD::Image::ChannelSet &channels, int count,
+													std::vector<DD::Image::RequestData> &requests )
+{
+	if( !this->input0() )
+		return;
+
+	DD::Image::Box sourceBox = this->warpBoundingBox( box, true );
+	sourceBox.intersect( this->input0()->deepInfo().box() );
+	requests.push_back( DD::Image::RequestData( this->input0(), sourceBox, channels, count ) );
+}
+
+//	This function is do all work, fill %plane% with the deep pixels of %box%
+//	Return false if aborted
+bool YnxDeepRollingShutterNode::doDeepEngine( DD::Image::Box box, const DD::Image::ChannelSet &channels,
+												DD::Image::DeepOutputPlane &plane )
+{
+	DD::Image::DeepOp *input = this->input0();
+	if( !input )
+		return true;
+
+	plane = DD::Image::DeepOutputPlane( channels, box );
+	const DD::Image::Box &inputBox = input->deepInfo().box();
+
+	//	per band buffers, each output pixel is warped once to the nearest
+	//		source pixel whatever its number of samples
+	int width = box.r() - box.x();
+	std::vector<Vector2> sourcePositions( width * DEEP_ROW_BAND_HEIGHT );
+	std::vector<int> sourceXs( sourcePositions.size() ), sourceYs( sourcePositions.size() );
+	std::unique_ptr<bool[]> isWarped( new bool[sourcePositions.size()] );
+	DD::Image::DeepOutPixel outputPixel;
+
+	for( int bandY = box.y() ; bandY < box.t() ; bandY += DEEP_ROW_BAND_HEIGHT )
+	{
+		//	stop immediately when this render is stale
+		if( this->aborted() )
+			return false;
+
+		//	warp all output positions of the band at once
+		int bandT = std::min( bandY + DEEP_ROW_BAND_HEIGHT, box.t() ),
+			numPixels = ( bandT - bandY ) * width;
+		for( int y = bandY, i = 0 ; y < bandT ; y++ )
+		{
+			for( int x = box.x() ; x < box.r() ; x++, i++ )
+				sourcePositions[i] = Vector2( x, y );
+		}
+		this->warpOutputToSourcePixels( sourcePositions.data(), numPixels, sourcePositions.data(), isWarped.get() );
+
+		//	nearest source pixels, and the region of the input they span
+		DD::Image::Box sourceBox( inputBox.r(), inputBox.t(), inputBox.x(), inputBox.y() );
+		bool isSourceBoxEmpty = true;
+		for( int i = 0 ; i < numPixels ; i++ )
+		{
+			if( !isWarped[i] )
+				continue;
+
+			sourceXs[i] = int( floor( sourcePositions[i].x + 0.5 ) );
+			sourceYs[i] = int( floor( sourcePositions[i].y + 0.5 ) );
+			isWarped[i] = sourceXs[i] >= inputBox.x() && sourceXs[i] < inputBox.r() &&
+							sourceYs[i] >= inputBox.y() && sourceYs[i] < inputBox.t();
+			if( !isWarped[i] )
+				continue;
+
+			sourceBox.set( std::min( sourceBox.x(), sourceXs[i] ), std::min( sourceBox.y(), sourceYs[i] ),
+							std::max( sourceBox.r(), sourceXs[i] + 1 ), std::max( sourceBox.t(), sourceYs[i] + 1 ) );
+			isSourceBoxEmpty = false;
+		}
+
+		//	fetch the deep pixels of the band from the input once
+		DD::Image::DeepPlane sourcePlane;
+		if( !isSourceBoxEmpty && !input->deepEngine( sourceBox, channels, sourcePlane ) )
+			return false;
+
+		//	copy every sample of the nearest source pixel, in the order of %box%
+		for( int i = 0 ; i < numPixels ; i++ )
+		{
+			if( !isWarped[i] )
+			{
+				plane.addHole();
+				continue;
+			}
+
+			DD::Image::DeepPixel sourcePixel = sourcePlane.getPixel( sourceYs[i], sourceXs[i] );
+			size_t numSamples = sourcePixel.getSampleCount();
+			outputPixel.clear();
+			outputPixel.reserve( numSamples * channels.size() );
+			for( size_t sample = 0 ; sample < numSamples ; sample++ )
+			{
+				foreach( channel, channels )
+					outputPixel.push_back( sourcePixel.getUnorderedSample( sample, channel ) );
+			}
+			plane.addPixel( outputPixel );
+		}
+	}
+
+	return true;
+}
+
+//	Function for create knob
+void YnxDeepRollingShutterNode::knobs( DD::Image::Knob_Callback f )
+{
+	//	get pointer to relevant parameters
+	int *inverseSolverPtr = this->rollingShutterLensDistortionEngine.getInverseSolverPtr();
+
+	Bool_knob(f, &this->isUndistort, "undistort");
+
+	//	knob for to choose the numerical inverse used when undistort
+	Enumeration_knob(f, inverseSolverPtr, INVERSE_SOLVER_NAMES, "inverseSolver");
+
+	//	knobs of the warp itself, shared with YnxRollingShutterNode
+	::rollingShutterEngineKnobs( f, &this->rollingShutterLensDistortionEngine );
+}
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+
+//	warp %numPixels% output pixel positions to the positions they take their
+//		deep samples from at once, %sourcePixels_ret% may be %outputPixels%.
+//		On return %isWarped_ret% tells whether the position is warped
+void YnxDeepRollingShutterNode::warpOutputToSourcePixels( const Vector2 *outputPixels, int numPixels,
+															Vector2 *sourcePixels_ret, bool *isWarped_ret ) const
+{
+	//	get width/height
+	int inputWidth = this->_deepInfo.format()->width(),
+		inputHeight = this->_deepInfo.format()->height();
+
+	//	normarlize output positions before warp
+	for( int i = 0 ; i < numPixels ; i++ )
+	{
+		Vector2 normalizedOutputPixel;
+		::normalizePoint( outputPixels[i], inputWidth, inputHeight, 1, &normalizedOutputPixel );
+		sourcePixels_ret[i] = normalizedOutputPixel;
+		isWarped_ret[i] = true;
+	}
+
+	if( this->isUndistort )
+		//	remove warp of the whole span and get source positions
+		this->rollingShutterLensDistortionEngine.removeWarpSpan( sourcePixels_ret, numPixels, sourcePixels_ret, isWarped_ret );
+	else
+	{
+		//	apply warp and get source positions
+		for( int i = 0 ; i < numPixels ; i++ )
+		{
+			try
+			{
+				sourcePixels_ret[i] = this->rollingShutterLensDistortionEngine.applyWarp( sourcePixels_ret[i] );
+			}
+			catch( ynxValueException &e )
+			{
+				//	can't warp this position
+				isWarped_ret[i] = false;
+			}
+		}
+	}
+
+	//	unnormalize source positions
+	for( int i = 0 ; i < numPixels ; i++ )
+	{
+		Vector2 normalizedSourcePixel( sourcePixels_ret[i] );
+		::unnormalizePoint( normalizedSourcePixel, inputWidth, inputHeight, 1, &sourcePixels_ret[i] );
+	}
+}
+
+//	get bounding box of %box% warped from output to source ( %isOutputToSource% )
+//		or from source to output, by warping positions along its edges
+DD::Image::Box YnxDeepRollingShutterNode::warpBoundingBox( const DD::Image::Box &box, bool isOutputToSource ) const
+{
+	//	get width/height
+	int width = this->_deepInfo.format()->width(),
+		height = this->_deepInfo.format()->height();
+
+	//	output to source is the warp applied when distort and removed when undistort
+	bool isApplyWarp = isOutputToSource != this->isUndistort;
+
+	double x = HUGE_VAL,
+			y = HUGE_VAL,
+			r = -HUGE_VAL,
+			t = -HUGE_VAL;
+	for( int i = 0 ; i <= DEEP_NUM_BOUNDING_BOX_SAMPLES ; i++ )
+	{
+		double fraction = double( i ) / DEEP_NUM_BOUNDING_BOX_SAMPLES,
+				sampleX = box.x() + ( box.r() - box.x() ) * fraction,
+				sampleY = box.y() + ( box.t() - box.y() ) * fraction;
+		Vector2 edgePositions[4] = { Vector2( sampleX, box.y() ), Vector2( sampleX, box.t() ),
+										Vector2( box.x(), sampleY ), Vector2( box.r(), sampleY ) };
+
+		for( int j = 0 ; j < 4 ; j++ )
+		{
+			//	warp the edge position, skip it if it can't be warped
+			Vector2 normalizedPosition, warpedPosition;
+			::normalizePoint( edgePositions[j], width, height, 1, &normalizedPosition );
+			try
+			{
+				if( isApplyWarp )
+					normalizedPosition = this->rollingShutterLensDistortionEngine.applyWarp( normalizedPosition );
+				else
+					normalizedPosition = this->rollingShutterLensDistortionEngine.removeWarp( normalizedPosition );
+			}
+			catch( ynxValueException &e )
+			{
+				continue;
+			}
+			::unnormalizePoint( normalizedPosition, width, height, 1, &warpedPosition );
+
+			x = std::min( x, warpedPosition.x );
+			y = std::min( y, warpedPosition.y );
+			r = std::max( r, warpedPosition.x );
+			t = std::max( t, warpedPosition.y );
+		}
+	}
+
+	//	nothing could be warped
+	if( x > r )
+		return box;
+
+	return DD::Image::Box( int( floor( x ) ) - 2, int( floor( y ) ) - 2, int( ceil( r ) ) + 2, int( ceil( t ) ) + 2 );
+}
+
+/*! This is a function that creates an instance of the operator, and is
+   needed for the Op::Description to work.
+ */
+static DD::Image::Op* YnxDeepRollingShutterNodeCreate(Node* node)
+{
+  return new YnxDeepRollingShutterNode(node);
+}
+
+const DD::Image::Op::Description YnxDeepRollingShutterNode::description ( DEEP_CLASS, "Yannix/YnxDeepRollingShutterNode",
+																			YnxDeepRollingShutterNodeCreate );
+
+//---------------------------------------------------------------------
+//
+//	END CLASS YnxDeepRollingShutterNode MEMBER FUNCTIONS
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
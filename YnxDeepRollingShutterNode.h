@@ -0,0 +1,187 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+#if !defined(___YnxDeepRollingShutterNode_h)
+#define ___YnxDeepRollingShutterNode_h
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <vector>
+
+//	Nuke
+#include <DDImage/DeepFilterOp.h>
+#include <DDImage/Knobs.h>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+//	yannix lens distortion engine
+#include "RollingShutterLensDistortionEngine.h"
+
+//---------------------------------------------------------------------
+//
+//	DEFINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	INLINES
+//
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+//
+//	GLOBALS
+//
+//---------------------------------------------------------------------
+
+//	Help for this node
+const char * const DEEP_HELP = "YnxDeepRollingShutterNode\n"
+"\n"
+"Apply or remove rolling shutter distortion on a deep image, with the same warp knobs as "
+"YnxRollingShutterNode. The warp ( or its inverse when undistort ) is computed once per output "
+"pixel and every deep sample of the nearest source pixel is moved there unchanged, deep samples "
+"are not filtered.";
+
+//	command for this node when create in nuke ( just like node name for creating in nuke )
+const char * const DEEP_CLASS = "YnxDeepRollingShutterNode";
+
+//---------------------------------------------------------------------
+//
+//	class YnxDeepRollingShutterNode
+//
+//---------------------------------------------------------------------
+class YnxDeepRollingShutterNode : public DD::Image::DeepFilterOp
+{
+	//---------------------------------------------------------------------
+	//	public member classes
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member data
+	//---------------------------------------------------------------------
+	public:
+
+		//	description for this node
+		static const DD::Image::Op::Description description;
+
+	//---------------------------------------------------------------------
+	//	protected member data
+	//---------------------------------------------------------------------
+	protected:
+
+		//----------------------------------
+		//	nuke node parameter
+		//
+
+		//	distortionengine class
+		RollingShutterLensDistortionEngine rollingShutterLensDistortionEngine;
+
+		//	is undistort
+		bool isUndistort;
+
+	//---------------------------------------------------------------------
+	//	private member data
+	//---------------------------------------------------------------------
+	private:
+
+	//---------------------------------------------------------------------
+	//	public contructors/destructors
+	//---------------------------------------------------------------------
+	public:
+		YnxDeepRollingShutterNode( Node *node );
+
+		virtual ~YnxDeepRollingShutterNode();
+
+	//---------------------------------------------------------------------
+	//	public access functions
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	public member functions
+	//---------------------------------------------------------------------
+	public:
+
+		//----------------------------------
+		//	Nuke methods
+		//
+
+		//	Return help information for this node
+		virtual const char* node_help() const
+		{ return DEEP_HELP; }
+
+		//	Return the command name that will be stored in Nuke scripts
+		virtual const char* Class() const
+		{ return DEEP_CLASS; }
+
+		//	Return this op
+		DD::Image::Op *op()
+		{ return this; }
+
+		//	This function is used for validate parameter value
+		virtual void _validate( bool for_real );
+
+		//	This function is used for request the region of the input deep image
+		//		needed to compute %box%
+		virtual void getDeepRequests( DD::Image::Box box, const DD::Image::ChannelSet &channels, int count,
+										std::vector<DD::Image::RequestData> &requests );
+
+		//	This function is do all work, fill %plane% with the deep pixels of %box%
+		//	Return false if aborted
+		virtual bool doDeepEngine( DD::Image::Box box, const DD::Image::ChannelSet &channels,
+									DD::Image::DeepOutputPlane &plane );
+
+		//	Function for create knob
+		virtual void knobs( DD::Image::Knob_Callback f );
+
+	//---------------------------------------------------------------------
+	//	public operator overloads
+	//---------------------------------------------------------------------
+	public:
+
+	//---------------------------------------------------------------------
+	//	protected member functions
+	//---------------------------------------------------------------------
+	protected:
+
+		//	warp %numPixels% output pixel positions to the positions they take their
+		//		deep samples from at once, %sourcePixels_ret% may be %outputPixels%.
+		//		On return %isWarped_ret% tells whether the position is warped
+		void warpOutputToSourcePixels( const Vector2 *outputPixels, int numPixels,
+										Vector2 *sourcePixels_ret, bool *isWarped_ret ) const;
+
+		//	get bounding box of %box% warped from output to source ( %isOutputToSource% )
+		//		or from source to output, by warping positions along its edges
+		DD::Image::Box warpBoundingBox( const DD::Image::Box &box, bool isOutputToSource ) const;
+
+	//---------------------------------------------------------------------
+	//	private member functions
+	//---------------------------------------------------------------------
+	private:
+
+};
+//---------------------------------------------------------------------
+//	END class YnxDeepRollingShutterNode
+//---------------------------------------------------------------------
+
+#endif
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
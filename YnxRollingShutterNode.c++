@@ -13,12 +13,17 @@
 //---------------------------------------------------------------------
 
 #include <assert.h>
+#include <stdlib.h>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <string>
 
 #include <DDImage/Tile.h>
 #include <DDImage/Pixel.h>
 #include <DDImage/Vector2.h>
+#include <DDImage/Application.h>
+#include <DDImage/Thread.h>
 
 //---------------------------------------------------------------------
 //
@@ -28,83 +33,67 @@
 
 #include "YnxRollingShutterNode.h"
 
+//	numerical inverse statistics
+#include "InvertWarpFuncs.h"
+
+//	per thread memory for per row buffers
+#include "ScratchArena.h"
+
+//	conversion between image space and engine space
+#include "PointNormalization.h"
+#include "RollingShutterKnobs.h"
+
 //---------------------------------------------------------------------
 //	DEFINES AND INLINES
 //---------------------------------------------------------------------
 
-//	defines
-#define FARAWAYDEPTH 1e10
+//	number of bounding box samples per edge for full quality and coarse pass
+#define NUM_BOUNDING_BOX_SAMPLES 32
+#define NUM_COARSE_BOUNDING_BOX_SAMPLES 8
 
-#define DEFAULT_LOWER_BOUND_VALUE -2
-#define DEFAULT_UPPER_BOUND_VALUE 2
+//	distance between coarse warp grid nodes ( in pixel )
+#define COARSE_WARP_GRID_SPACING 16
 
-//	debug flags
-// #define DEBUG_KNOBS
-// #define DEBUG_ENGINE
-// #define DEBUG_VALIDATE
-// #define DEBUG_REQUEST
-// #define DEBUG_NORMAILIZE_POINT
+//	number of pixels rendered between checks for an aborted render
+#define ABORT_CHECK_INTERVAL 16
 
-//---------------------------------------------------------------------
-//	normalize/unnormalize functions
-
-//	convert from image space to normalized [0,1] [( 1 - height/width )/2,height/width + ( 1 - height/width )/2] space 
-inline void normalizePoint( const Vector2 &p, 
-									double imageWidth, double imageHeight, 
-									double pixelAspectRatio, 
-									Vector2 *normalizedP_ret )
-{
-#ifdef DEBUG_NORMAILIZE_POINT
-	std::cout << "\n **********************************************" << std::endl;
-	std::cout << "   normalizePoint( p = ( " << p.x << ", " << p.y 
-				<< " ), width = " << imageWidth << ", height = " << imageHeight
-				<< ", pixelAspectRatio = " << pixelAspectRatio << " )" << std::endl;
-#endif
-	//	unsqueeze
-	normalizedP_ret->copy( p );
-	normalizedP_ret->x *= pixelAspectRatio;
-#ifdef DEBUG_NORMAILIZE_POINT
-	std::cout << "  unsqueeze = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
-#endif
-	//	Convert coordinate to [0,1], [0,height/width]
-	normalizedP_ret->divide( imageWidth * pixelAspectRatio );
+//	precision of invertibility domain edges ( in pixel )
+#define INVERTIBILITY_DOMAIN_TOLERANCE 0.25
 
-#ifdef DEBUG_NORMAILIZE_POINT
-	std::cout << "  convert to [0,1], [0,height/width] = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
-#endif
+//	distance between warm start grid nodes and default error allowed when
+//		the previous frame's inverse is used as is ( in pixel )
+#define WARM_START_GRID_SPACING 8
+#define DEFAULT_WARM_START_TOLERANCE 0.05
 
-	//	Convert coordinate to [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ]
-	normalizedP_ret->y += ( 1 - ( imageHeight / imageWidth / pixelAspectRatio ) ) / 2;
+//	maximum number of subsamples along x and y of an output pixel
+#define MAX_SUPERSAMPLING 8
 
-#ifdef DEBUG_NORMAILIZE_POINT
-	std::cout << "  convert to [-1,1], [-height/width,height/width] = ( " << normalizedP_ret->x << ", " << normalizedP_ret->y << " )" << std::endl;
-#endif			
-}
+//	largest error of source positions read from the displacement cache or the
+//		eager warp ( in pixel ), frames whose displacements can't be encoded within
+//		it aren't saved or warped eagerly
+#define DISPLACEMENT_CACHE_MAX_ERROR 0.01
 
-//	convert from normalized [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ] space
-//		to image space
-inline void unnormalizePoint( const Vector2 &p, 
-										double imageWidth, double imageHeight, 
-										double pixelAspectRatio, 
-										Vector2 *unnormalizedP_ret )
-									throw( ynxValueException )
-{
-	//	Convert coordinate to [0,1], [( 1 - height/width )/2 , height/width + ( 1 - height/width )/2 ]
-	unnormalizedP_ret->copy( p ); 
- 	unnormalizedP_ret->y -= ( 1 - ( imageHeight / imageWidth / pixelAspectRatio ) ) / 2;			
-
-	//	Convert coordinate to [0,1], [0,height/width]
-	unnormalizedP_ret->multiply( imageWidth * pixelAspectRatio );
-
-	//	Unsqueeze
-	unnormalizedP_ret->x /= pixelAspectRatio;			
-}
+//	the largest displacement is estimated from the bounding box edges only, it
+//		is scaled and padded ( in pixel ) to cover the inside of the frame
+#define MAX_DISPLACEMENT_ESTIMATE_SCALE 1.25
+#define MAX_DISPLACEMENT_ESTIMATE_PADDING 8
 
+//	debug flags
+// #define DEBUG_KNOBS
+// #define DEBUG_ENGINE
+// #define DEBUG_VALIDATE
+// #define DEBUG_REQUEST
+// #define DEBUG_SOLVER_STATISTICS
 
 //---------------------------------------------------------------------
 //	GLOBALS
 //---------------------------------------------------------------------
 
+#ifdef DEBUG_SOLVER_STATISTICS
+//	statistics of removeWarp solves of all nodes
+static InvertWarpStatistics sInvertWarpStatistics;
+#endif
+
 
 //---------------------------------------------------------------------
 //	FILE SCOPE FUNCTION PROTOTYPES
@@ -156,10 +145,58 @@ YnxRollingShutterNode::YnxRollingShutterNode( Node *node ) : DD::Image::Iop( nod
 	//	set default for undistort
 	this->isUndistort = false;
 	
+	//	set default for concatenate
+	this->isConcatenate = true;
+	
+	//	set default for progressive
+	this->isProgressive = true;
+	
+	//	set default for supersampling ( one sample per pixel )
+	this->supersampling = 1;
+	
+	//	set default for warm start
+	this->isWarmStart = false;
+	this->warmStartTolerance = DEFAULT_WARM_START_TOLERANCE;
+	this->isWarmStartReused = false;
+	
+	//	motion from the knobs
+	this->motionSidecarPath = NULL;
+	
+	//	no displacement cache
+	this->displacementCacheDirectory = NULL;
+	
+	//	warp rows in engine
+	this->isEagerWarp = false;
+	
+	//	nothing to sample until validated
+	this->sourceIop = NULL;
+	this->warpDataKey = 0;
+	
+	//	full quality until a warp change is seen
+	this->isCoarsePass = false;
+	this->warpHash = 0;
+	this->refinedWarpHash = 0;
+	this->nearestFilter.type( DD::Image::Filter::Impulse );
+	
+#ifdef DEBUG_SOLVER_STATISTICS
+	this->rollingShutterLensDistortionEngine.setInvertWarpStatistics( &sInvertWarpStatistics );
+#endif
+	
 }
 YnxRollingShutterNode::~YnxRollingShutterNode()
 {
+	//	stop threads warping this node or watching its coarse pass
+	this->frameWarpMap.reset();
+	this->coarsePassTracker.reset();
 	
+#ifdef DEBUG_SOLVER_STATISTICS
+	long numSolves = std::max( sInvertWarpStatistics.numSolves.load(), 1L );
+	std::cout << "YnxRollingShutterNode removeWarp statistics : solves = " << sInvertWarpStatistics.numSolves
+				<< ", predictor accepted = " << 100.0 * sInvertWarpStatistics.numInitialGuessAccepted / numSolves << "%"
+				<< ", failures = " << sInvertWarpStatistics.numFailures
+				<< ", iterations/solve = " << double( sInvertWarpStatistics.numIterations ) / numSolves
+				<< ", step halvings/solve = " << double( sInvertWarpStatistics.numStepHalvings ) / numSolves << std::endl;
+#endif
 }
 	//---------------------------------------------------------------------
 	//	public access functions
@@ -180,88 +217,88 @@ void YnxRollingShutterNode::engine( int y, int x, int r,
 	//	construct pixel for store pixel value 	
 	DD::Image::Pixel pixel( channelMask );
 		
-	//	construct ynx vector2 for send position to apply warp and get the results
-	Vector2 normalizedInputPositionXYYnxVector, normalizedOutputPositionXYYnxVector,
-			inputPositionXYYnxVector, outputPositionXYYnxVector;
+	//	get progressive pass once for the whole row
+	bool isCoarsePass = this->isCoarsePass;
 	
-	//	get width/height
-	int inputWidth = this->format().width(),
-	    inputHeight = this->format().height();
+	//	stop immediately when this render is stale
+	if( this->aborted() )
+		return;
 	
-	//	loop all position in this row ( x ) 
-	//		and apply warp
-	for( ; x < r ; x++ )
+	//	all per row buffers come from the scratch arena of this thread and
+	//		are freed when the row is done
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	
+	//	warp all output positions of the row through this node and all concatenated 
+	//		nodes at once, or interpolate them from the coarse grid in the coarse pass
+	int rowSize = r - x;
+	Vector2 *sourcePositions = scratchArena.allocate<Vector2>( rowSize );
+	bool *isWarped = scratchArena.allocate<bool>( rowSize );
+	for( int i = 0 ; i < rowSize ; i++ )
 	{
-		//	normarlize input position before apply warp
-		inputPositionXYYnxVector = Vector2( x, y );
-		::normalizePoint( inputPositionXYYnxVector, inputWidth, inputHeight, 1, &normalizedInputPositionXYYnxVector );
-		bool isCannotWarp = false;
-		if( this->isUndistort )
-		{
-			try
-			{
-				//	remove warp and get output position
-				normalizedOutputPositionXYYnxVector = this->rollingShutterLensDistortionEngine.removeWarp( normalizedInputPositionXYYnxVector );
-			}
-			catch( ynxValueException &e )
-			{
-				//	set flag can't to true
-				//		if can't warp the pixel value will be 0 ( black )
-				isCannotWarp = true;
-			}		
-		}
-		
-		else
-		{
-			try
-			{
-				//	apply warp and get output position
-				normalizedOutputPositionXYYnxVector = this->rollingShutterLensDistortionEngine.applyWarp( normalizedInputPositionXYYnxVector );
-			}
-			catch( ynxValueException &e )
-			{
-				//	set flag can't to true
-				//		if can't warp the pixel value will be 0 ( black )			
-				isCannotWarp = true;
-			}
-		}
-		
-		//	unnormalize output position
-		::unnormalizePoint( normalizedOutputPositionXYYnxVector, inputWidth, inputHeight, 1, &outputPositionXYYnxVector );
-		
-		//	if can't warp position
-		//		set that position pixel value to black 
-		if( isCannotWarp )
-		{
-			foreach( channel, channelMask )
-			{
-				pixel[channel] = 0;
-			}
-		}
-		
+		if( isCoarsePass )
+			isWarped[i] = this->warpData->coarseWarpGrid.interpolate( Vector2( x + i, y ), &sourcePositions[i] );
 		else
 		{
-			//	get pixel value to set to image
-			input(0)->sample( 
-								//	llx
-								outputPositionXYYnxVector.x + 0.5f, 
-								//	lly
-								outputPositionXYYnxVector.y + 0.5f,
-								//	size to get data x ( in pixel )
-								1.0f,
-								//	size to get data y ( in pixel )
-								1.0f,
-								//	pixel result
-								pixel );
+			sourcePositions[i] = Vector2( x + i, y );
+			isWarped[i] = true;
 		}
-
-		//	loop all channel and set value that we get 					
- 		foreach( channel, channelMask )
- 		{
- 			outputRow.writable( channel );
- 			( (float *)outputRow[channel] )[x] = pixel[channel];
- 		}
 	}
+	
+	//	subsamples of the full quality pass are extrapolated from the warp of every
+	//		pixel center by its jacobian, so each pixel is still warped only once
+	int supersampling = isCoarsePass ? 1 : std::max( 1, std::min( this->supersampling, MAX_SUPERSAMPLING ) );
+	Vector2 *partialsX = NULL,
+			*partialsY = NULL;
+	if( supersampling > 1 )
+	{
+		partialsX = scratchArena.allocate<Vector2>( rowSize );
+		partialsY = scratchArena.allocate<Vector2>( rowSize );
+	}
+	if( this->displacementCacheFile && !isCoarsePass )
+		this->displacementCacheFile->getSourcePixels( y, x, r, sourcePositions, isWarped );
+	else if( this->frameWarpMap && !isCoarsePass )
+	{
+		if( !this->frameWarpMap->getSourcePixels( y, x, r, sourcePositions, isWarped ) )
+			return;
+	}
+	else if( !isCoarsePass )
+		this->warpOutputToSourcePixels( sourcePositions, rowSize, sourcePositions, isWarped, partialsX, partialsY );
+	
+	//	resolve channels and their output pointers once for the row
+	int numChannels = channelMask.size();
+	DD::Image::Channel *channels = scratchArena.allocate<DD::Image::Channel>( numChannels );
+	float **outputs = scratchArena.allocate<float *>( numChannels );
+	int channelIndex = 0;
+	foreach( channel, channelMask )
+	{
+		channels[channelIndex] = channel;
+		outputs[channelIndex] = outputRow.writable( channel );
+		channelIndex ++;
+	}
+	
+	//	sample the warped positions with the loop specialized for the pass and
+	//		for rgb, rgba, rgba+depth or any number of channels
+	bool isRowDone;
+	if( supersampling > 1 )
+	{
+		float *channelSums = scratchArena.allocate<float>( numChannels );
+		isRowDone = this->supersampleRowForNumChannels( x, r, sourcePositions, isWarped, 
+														partialsX, partialsY, supersampling,
+														channels, numChannels, outputs, channelSums, pixel );
+	}
+	else if( isCoarsePass )
+		isRowDone = this->sampleRowForNumChannels<true>( x, r, sourcePositions, isWarped, 
+														channels, numChannels, outputs, pixel );
+	else
+		isRowDone = this->sampleRowForNumChannels<false>( x, r, sourcePositions, isWarped, 
+														channels, numChannels, outputs, pixel );
+	if( !isRowDone )
+		return;
+	
+	//	once the coarse pass is done, render again in full quality
+	if( isCoarsePass && this->coarsePassTracker )
+		this->coarsePassTracker->markRowDone( y );
 }
 
 //	Function for create knob ( knobs are fundamentals of all user interface elements available to NUKE Ops. )
@@ -273,100 +310,51 @@ void YnxRollingShutterNode::knobs( DD::Image::Knob_Callback f )
 #endif	
 
 	//	get pointer to relevant parameters
-	double *rollingShutterRatioPtr = this->rollingShutterLensDistortionEngine.getRollingShutterRatioPtr();
-	double *topPointDepthPtr = this->rollingShutterLensDistortionEngine.getTopPointDepthPtr();
-	double *bottomPointDepthPtr = this->rollingShutterLensDistortionEngine.getBottomPointDepthPtr();
-	RollingShutterSingleFrameMotion *currentMotionDataPtr = this->rollingShutterLensDistortionEngine.getCurrentMotionDataPtr();
+	int *inverseSolverPtr = this->rollingShutterLensDistortionEngine.getInverseSolverPtr();
 			
 	
 	Bool_knob(f, &this->isUndistort, "undistort");
 	
-	//	knob for to set value for rolling shutter ratio
-	Double_knob(f, rollingShutterRatioPtr, DD::Image::IRange(0, 1), "rollingShutterRatio");
+	//	knob for to concatenate with an upstream rolling shutter node
+	//		so both warps are resampled only once
+	Bool_knob(f, &this->isConcatenate, "concatenate");
 	
-	//	knob for to set value for top point depth
-	Double_knob(f, topPointDepthPtr, DD::Image::IRange(0, FARAWAYDEPTH), "topPointDepth");
+	//	knob for to render the viewer coarse first then in full quality
+	//		( gui sessions only, farm renders are always full quality )
+	Bool_knob(f, &this->isProgressive, "progressive");
 	
-	//	knob for to set value for bottom point depth
-	Double_knob(f, bottomPointDepthPtr, DD::Image::IRange(0, FARAWAYDEPTH), "bottomPointDepth");
+	//	knob for to warp the whole frame in parallel before the first engine call, 
+	//		engine then only samples ( full quality pass with a single sample per pixel )
+	Bool_knob(f, &this->isEagerWarp, "eagerWarp");
 	
-	//------------------------------------
-	//	Top
+	//	knob for to take supersampling x supersampling samples per output pixel 
+	//		( 1 to MAX_SUPERSAMPLING ) in the full quality pass, against aliasing
+	//		where the warp minifies, e.g. in the corners when undistort
+	Int_knob(f, &this->supersampling, "supersampling");
 	
-	//	knob for to set value for top left previous x
-	Double_knob(f, &currentMotionDataPtr->top[0].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftPrevX");
+	//	knob for to choose the numerical inverse used when undistort
+	Enumeration_knob(f, inverseSolverPtr, INVERSE_SOLVER_NAMES, "inverseSolver");
 	
-	//	knob for to set value for top left previous y
-	Double_knob(f, &currentMotionDataPtr->top[0].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftPrevY");
+	//	knob for to start undistort from the previous frame rendered by this node,
+	//		and the error ( in pixel ) allowed to use the previous frame's inverse as is
+	Bool_knob(f, &this->isWarmStart, "warmStart");
+	Double_knob(f, &this->warmStartTolerance, DD::Image::IRange(0, 1), "warmStartTolerance");
 	
-	//	knob for to set value for top left next x
-	Double_knob(f, &currentMotionDataPtr->top[0].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftNextX");
+	//	knob for to read the motion of every frame from a CSV sidecar instead of the motion
+	//		knobs below, either 25 columns ( frame then every motion knob in order ) or gyro
+	//		samples of 4 columns ( time, angular velocity x, y, z ) converted with the frame 
+	//		rate, gyro time of frame 0 and focal length ( in NDC, image width spans [-1,1] )
+	File_knob(f, &this->motionSidecarPath, "motionSidecar");
+	Double_knob(f, &this->gyroConversion.frameRate, DD::Image::IRange(1, 120), "sidecarFrameRate");
+	Double_knob(f, &this->gyroConversion.timeOffset, DD::Image::IRange(-10, 10), "sidecarTimeOffset");
+	Double_knob(f, &this->gyroConversion.focalLength, DD::Image::IRange(0.5, 5), "sidecarFocalLength");
 	
-	//	knob for to set value for top left next y
-	Double_knob(f, &currentMotionDataPtr->top[0].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topLeftNextY");
-
-	//	knob for to set value for top middle previous x
-	Double_knob(f, &currentMotionDataPtr->top[1].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddlePrevX");
-	
-	//	knob for to set value for top middle previous y
-	Double_knob(f, &currentMotionDataPtr->top[1].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddlePrevY");
-	
-	//	knob for to set value for top middle next x
-	Double_knob(f, &currentMotionDataPtr->top[1].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddleNextX");
-	
-	//	knob for to set value for top middle next y
-	Double_knob(f, &currentMotionDataPtr->top[1].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topMiddleNextY");
-	
-	//	knob for to set value for top right previous x
-	Double_knob(f, &currentMotionDataPtr->top[2].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightPrevX");
-	
-	//	knob for to set value for top right previous y
-	Double_knob(f, &currentMotionDataPtr->top[2].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightPrevY");
-	
-	//	knob for to set value for top right next x
-	Double_knob(f, &currentMotionDataPtr->top[2].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightNextX");
-	
-	//	knob for to set value for top right next y
-	Double_knob(f, &currentMotionDataPtr->top[2].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "topRightNextY");
-	
-	//------------------------------------
-	//	Bottom
-
-	//	knob for to set value for bottom left previous x
-	Double_knob(f, &currentMotionDataPtr->bottom[0].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftPrevX");
-	
-	//	knob for to set value for bottom left previous y
-	Double_knob(f, &currentMotionDataPtr->bottom[0].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftPrevY");
-	
-	//	knob for to set value for bottom left next x
-	Double_knob(f, &currentMotionDataPtr->bottom[0].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftNextX");
-	
-	//	knob for to set value for bottom left next y
-	Double_knob(f, &currentMotionDataPtr->bottom[0].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomLeftNextY");
-
-	//	knob for to set value for bottom middle previous x
-	Double_knob(f, &currentMotionDataPtr->bottom[1].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddlePrevX");
+	//	knob for a directory ( e.g. shared by the farm ) where the source positions of 
+	//		every frame are saved once and memory mapped by later renders of it
+	File_knob(f, &this->displacementCacheDirectory, "displacementCache");
 	
-	//	knob for to set value for bottom middle previous y
-	Double_knob(f, &currentMotionDataPtr->bottom[1].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddlePrevY");
-	
-	//	knob for to set value for bottom middle next x
-	Double_knob(f, &currentMotionDataPtr->bottom[1].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddleNextX");
-	
-	//	knob for to set value for bottom middle next y
-	Double_knob(f, &currentMotionDataPtr->bottom[1].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomMiddleNextY");
-	
-	//	knob for to set value for bottom right previous x
-	Double_knob(f, &currentMotionDataPtr->bottom[2].previousPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightPrevX");
-	
-	//	knob for to set value for bottom right previous y
-	Double_knob(f, &currentMotionDataPtr->bottom[2].previousPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightPrevY");
-	
-	//	knob for to set value for bottom right next x
-	Double_knob(f, &currentMotionDataPtr->bottom[2].nextPosition.x, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightNextX");
-	
-	//	knob for to set value for bottom right next y
-	Double_knob(f, &currentMotionDataPtr->bottom[2].nextPosition.y, DD::Image::IRange( DEFAULT_LOWER_BOUND_VALUE, DEFAULT_UPPER_BOUND_VALUE ), "bottomRightNextY");
+	//	knobs of the warp itself, shared with YnxDeepRollingShutterNode
+	::rollingShutterEngineKnobs( f, &this->rollingShutterLensDistortionEngine );
 	
 	
 }
@@ -377,9 +365,37 @@ void YnxRollingShutterNode::_validate( bool for_real )
 #ifdef DEBUG_VALIDATE
 	std::cout << "YnxRollingShutterNode::_validate()" << std::endl;
 #endif
+	//	stop warping the frame and watching the coarse pass before anything
+	//		they use changes
+	this->frameWarpMap.reset();
+	this->coarsePassTracker.reset();
+	
 	//	do nothing if there's no input 	
 	if( !this->input(0) )
 	{ return; }
+	
+	//	motion of this frame from the sidecar replaces the motion knobs, the
+	//		index is opened ( and refreshed when the sidecar changed ) here
+	//		rather than in append so the gui thread reads no file
+	this->updateMotionFromSidecar();
+	
+	//	render the coarse pass first whenever warp parameters changed in a gui session,
+	//		the full quality pass follows once the coarse pass is done. The pass is
+	//		decided here, while no engine runs, append only hashes it. A coarse pass
+	//		finishing in between only renders this one in full quality under the
+	//		hash of a coarse pass
+	this->warpHash = this->computeWarpHash();
+	this->isCoarsePass = this->isCoarsePassPending( this->warpHash );
+	
+	//	a sidecar which can't be read is an error, a frame missing from
+	//		it uses the motion knobs
+	if( !this->motionSidecarError.empty() )
+	{
+		this->error( "%s", this->motionSidecarError.c_str() );
+		return;
+	}
+	if( !this->motionSidecarWarning.empty() )
+		this->warning( "%s", this->motionSidecarWarning.c_str() );
 
 #ifdef DEBUG_VALIDATE
 	RollingShutterSingleFrameMotion *currentMotionDataPtr = this->rollingShutterLensDistortionEngine.getCurrentMotionDataPtr();
@@ -407,21 +423,22 @@ void YnxRollingShutterNode::_validate( bool for_real )
 	std::cout << "		this->bottomRightNext(X,Y) = " << currentMotionDataPtr->bottom[2].nextPosition.x << ", " << currentMotionDataPtr->bottom[2].nextPosition.y << " ) " << std::endl;
 			
 #endif
-	//	precompute the rolling shutter warp 
-	this->rollingShutterLensDistortionEngine.precompute();
-
-#ifdef DEBUG_VALIDATE
-	std::cout << "		this->getBottomPointWarpOffset(X,Y)[0] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(0).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(0).y << std::endl;
-	std::cout << "		this->getBottomPointWarpOffset(X,Y)[1] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(1).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(1).y << std::endl;
-	std::cout << "		this->getBottomPointWarpOffset(X,Y)[2] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(2).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(2).y << std::endl;
-
-	std::cout << "		this->getTopPointWarpOffset(X,Y)[0] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(0).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(0).y << std::endl;
-	std::cout << "		this->getTopPointWarpOffset(X,Y)[1] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(1).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(1).y << std::endl;
-	std::cout << "		this->getTopPointWarpOffset(X,Y)[2] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(2).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(2).y << std::endl;		
-#endif
-		
 	//	validate the input of this node
 	this->input(0)->validate( for_real );
+	
+	//	collect upstream rolling shutter nodes to concatenate, the upstream
+	//		node has already collected its own chain when it was validated
+	this->concatenatedNodes.clear();
+	this->sourceIop = this->input(0);
+	const YnxRollingShutterNode *upstreamNode = dynamic_cast<const YnxRollingShutterNode *>( this->input(0) );
+	if( this->isConcatenate && upstreamNode != NULL && upstreamNode->sourceIop != NULL )
+	{
+		this->concatenatedNodes.push_back( upstreamNode );
+		this->concatenatedNodes.insert( this->concatenatedNodes.end(), 
+										upstreamNode->concatenatedNodes.begin(), 
+										upstreamNode->concatenatedNodes.end() );
+		this->sourceIop = upstreamNode->sourceIop;
+	}
 
 	//	copy data from input into info_
 	this->copy_info();
@@ -429,21 +446,60 @@ void YnxRollingShutterNode::_validate( bool for_real )
 	
  	this->info_.black_outside( false );
  	
-	//	compute bounding box by sampling point and warp to get min, max to decide as bounding box
-	DD::Image::Box boundingBox = this->getBoundingBox( this->input0().info().x(), 
-							  this->input0().info().y(), 
-							  this->input0().info().r(), 
-							  this->input0().info().t() );
+	//	look up warp data shared by all instances with identical parameters,
+	//		compute and share it when missing
+	this->warpDataKey = this->computeWarpDataKey( for_real );
+	std::shared_ptr<const WarpData> warpData = WarpDataCache::getInstance().find( this->warpDataKey );
+	if( warpData )
+		this->rollingShutterLensDistortionEngine.copyPrecomputedValues( warpData->engine );
+	else
+	{
+		warpData = this->computeWarpData( for_real );
+		WarpDataCache::getInstance().insert( this->warpDataKey, warpData );
+	}
+	this->warpData = warpData;
 	
 	//	copy input's bounding box
 	DD::Image::Box inputBoundingBox = this->info_;
 	
 	//	merge the bouding box of input and bounding box after sampling some pixel
-	inputBoundingBox.merge( boundingBox );
+	inputBoundingBox.merge( DD::Image::Box( warpData->boundingBox[0], warpData->boundingBox[1], 
+											warpData->boundingBox[2], warpData->boundingBox[3] ) );
 	
 	//	set the new bounding box size
 	this->info_.set( inputBoundingBox );
 	
+	//	source positions of the whole frame saved on disk replace the warp in engine
+	//		( full quality renders with a single sample per pixel only ), they are 
+	//		computed without warm start so they don't depend on the previous frame
+	this->displacementCacheFile.reset();
+	this->warmStartInverse.reset();
+	this->isWarmStartReused = false;
+	this->updateWarpStates();
+	if( for_real && !this->isCoarsePass && this->supersampling <= 1 && 
+		this->displacementCacheDirectory != NULL && this->displacementCacheDirectory[0] != '\0' )
+		this->updateDisplacementCacheFile();
+	
+	//	start undistort solves from the previous frame rendered by this node
+	if( for_real && this->isUndistort && this->isWarmStart && !this->isCoarsePass && !this->displacementCacheFile )
+	{
+		this->updateWarmStartInverse();
+		this->updateWarpStates();
+	}
+	
+	//	prepare the coarse pass, the full quality pass follows once it is done
+	if( this->isCoarsePass && for_real )
+	{
+		this->nearestFilter.initialize();
+		uint64_t warpHash = this->warpHash;
+		this->coarsePassTracker.reset( new CoarsePassTracker( this->info_.y(), this->info_.t(),
+																[this, warpHash]()
+																{
+																	this->refinedWarpHash = warpHash;
+																	this->asapUpdate();
+																} ) );
+	}
+	
 }
 
 //	This function is used for request region of data before send into engine func
@@ -455,11 +511,26 @@ void YnxRollingShutterNode::_request( int x, int y, int r, int t, DD::Image::Cha
 	
 	//	get bounding box by sampling the position and warp
 	//		to get bounding box
-	DD::Image::Box boundingBox = this->getBoundingBox( x, y, r, t );
+	DD::Image::Box boundingBox = this->getBoundingBox( x, y, r, t, 
+														this->isCoarsePass ? NUM_COARSE_BOUNDING_BOX_SAMPLES : NUM_BOUNDING_BOX_SAMPLES );
 	
-	//	request the region that bounding box intersect with input image
-	boundingBox.intersect( this->input0().info() );
-	this->input0().request( boundingBox.x(),
+	//	carry the region back through every concatenated node
+	for( size_t i = 0 ; i < this->concatenatedNodes.size() ; i++ )
+	{
+		boundingBox = this->concatenatedNodes[i]->getBoundingBox( boundingBox.x(), 
+																boundingBox.y(), 
+																boundingBox.r(), 
+																boundingBox.t(),
+																this->isCoarsePass ? NUM_COARSE_BOUNDING_BOX_SAMPLES : NUM_BOUNDING_BOX_SAMPLES );
+	}
+	
+	//	subsamples spread a pixel around the warped pixel center
+	if( this->supersampling > 1 && !this->isCoarsePass )
+		boundingBox.set( boundingBox.x() - 1, boundingBox.y() - 1, boundingBox.r() + 1, boundingBox.t() + 1 );
+	
+	//	request the region that bounding box intersect with the sampled image
+	boundingBox.intersect( this->sourceIop->info() );
+	this->sourceIop->request( boundingBox.x(),
 						boundingBox.y(),
 						boundingBox.r(),
 						boundingBox.t(),
@@ -468,6 +539,303 @@ void YnxRollingShutterNode::_request( int x, int y, int r, int t, DD::Image::Cha
 	
 }
 
+//	This function is called before the first engine call
+void YnxRollingShutterNode::_open()
+{
+	//	warp the whole frame in blocks of rows, engine then only waits for the block
+	//		of its row. Engine threads warp the blocks of their rows themselves, so one
+	//		thread less than Nuke's number keeps the machine from being oversubscribed.
+	//		The threads warp with a copy of the warp states, never reading this node 
+	//		or an upstream one, and stop as soon as the render is aborted
+	if( this->isEagerWarp && !this->isCoarsePass && this->supersampling <= 1 && 
+		!this->displacementCacheFile && !this->frameWarpMap )
+	{
+		std::vector<WarpState> warpStates( this->warpStates );
+		this->frameWarpMap.reset( new FrameWarpMap( this->info_.x(), this->info_.y(), this->info_.r(), this->info_.t(),
+													this->estimateMaxDisplacement(),
+													[warpStates]( const Vector2 *outputPixels, int numPixels, 
+																	Vector2 *sourcePixels_ret, bool *isWarped_ret )
+													{ 
+														YnxRollingShutterNode::warpOutputToSourcePixels( warpStates, outputPixels, numPixels, 
+																										sourcePixels_ret, isWarped_ret ); 
+													},
+													[this]() { return this->aborted(); } ) );
+		
+		//	warps too large to encode precisely enough are done row by row in engine
+		if( this->frameWarpMap->getMaxError() > DISPLACEMENT_CACHE_MAX_ERROR )
+			this->frameWarpMap.reset();
+		else
+			this->frameWarpMap->start( int( DD::Image::Thread::numThreads ) - 1 );
+	}
+}
+
+//	This function is called when the node won't be rendered for a while
+void YnxRollingShutterNode::_close()
+{
+	//	free the frame's source positions
+	this->frameWarpMap.reset();
+}
+
+//	This function is used for add values that affect the output but not stored in knobs
+//		into the hash of this node
+void YnxRollingShutterNode::append( DD::Image::Hash &hash )
+{
+	//	motion of this frame from the sidecar replaces the motion knobs, it is
+	//		only looked up in the index opened by _validate, which applies it
+	int frame = int( floor( this->outputContext().frame() + 0.5 ) );
+	RollingShutterSingleFrameMotion sidecarMotion;
+	bool isSidecarMotion = this->motionSidecarIndex && this->motionSidecarIndex->getFrameMotion( frame, &sidecarMotion );
+	
+	//	hash of warp parameters of this render, and whether it starts with the
+	//		coarse pass ( the members engine reads are set in _validate )
+	uint64_t warpHash = this->computeWarpHash( isSidecarMotion ? &sidecarMotion : NULL );
+	hash.append( this->isCoarsePassPending( warpHash ) );
+	
+	//	sidecar motion is in no knob, it is hashed with the warp parameters, and
+	//		the frame tells frames apart before the index is opened
+	if( this->motionSidecarPath != NULL && this->motionSidecarPath[0] != '\0' )
+	{
+		hash.append( frame );
+		hash.append( unsigned( warpHash ) );
+		hash.append( unsigned( warpHash >> 32 ) );
+	}
+}
+
+//	warp an output pixel position of this node to the position it samples
+//		from its input, return false if the position can't be warped
+bool YnxRollingShutterNode::warpOutputToInputPixel( const Vector2 &outputPixel, Vector2 *inputPixel_ret ) const
+{
+	//	get width/height
+	int inputWidth = this->format().width(),
+	    inputHeight = this->format().height();
+	
+	//	normarlize output position before warp
+	Vector2 normalizedOutputPixel, normalizedInputPixel;
+	::normalizePoint( outputPixel, inputWidth, inputHeight, 1, &normalizedOutputPixel );
+	
+	//	skip positions known to be outside of the region where the warp
+	//		can be removed
+	if( this->isUndistort && !this->warpData->invertibilityDomain.isInvertible( normalizedOutputPixel ) )
+		return false;
+	
+	try
+	{
+		if( this->isUndistort )
+			//	remove warp and get input position
+			normalizedInputPixel = this->rollingShutterLensDistortionEngine.removeWarp( normalizedOutputPixel );
+		else
+			//	apply warp and get input position
+			normalizedInputPixel = this->rollingShutterLensDistortionEngine.applyWarp( normalizedOutputPixel );
+	}
+	catch( ynxValueException &e )
+	{
+		//	can't warp this position
+		return false;
+	}
+	
+	//	unnormalize input position
+	::unnormalizePoint( normalizedInputPixel, inputWidth, inputHeight, 1, inputPixel_ret );
+	
+	return true;
+}
+
+//	warp an output pixel position of this node through all concatenated
+//		nodes to the position it samples from this->sourceIop
+bool YnxRollingShutterNode::warpOutputToSourcePixel( const Vector2 &outputPixel, Vector2 *sourcePixel_ret ) const
+{
+	//	warp through this node first
+	if( !this->warpOutputToInputPixel( outputPixel, sourcePixel_ret ) )
+		return false;
+	
+	//	then the output of each concatenated node is warped to its own input
+	for( size_t i = 0 ; i < this->concatenatedNodes.size() ; i++ )
+	{
+		Vector2 upstreamOutputPixel( *sourcePixel_ret );
+		if( !this->concatenatedNodes[i]->warpOutputToInputPixel( upstreamOutputPixel, sourcePixel_ret ) )
+			return false;
+	}
+	
+	return true;
+}
+
+//	warp %numPixels% output pixel positions of this node through all concatenated
+//		nodes to the positions they sample from this->sourceIop at once,
+//		%sourcePixels_ret% may be %outputPixels%. On entry a false in
+//		%isWarped_ret% skips that position, on return it tells whether the
+//		position is warped. If %partialsX_ret% and %partialsY_ret% are given they
+//		are filled with the partial derivatives of the source position along
+//		output x and y, chained through every concatenated node. %isWarmStartUsed%
+//		applies to every node
+void YnxRollingShutterNode::warpOutputToSourcePixels( const Vector2 *outputPixels, int numPixels, 
+														Vector2 *sourcePixels_ret, bool *isWarped_ret,
+														Vector2 *partialsX_ret, Vector2 *partialsY_ret,
+														bool isWarmStartUsed /*= true*/ ) const
+{
+	YnxRollingShutterNode::warpOutputToSourcePixels( this->warpStates, outputPixels, numPixels, sourcePixels_ret, isWarped_ret,
+														partialsX_ret, partialsY_ret, isWarmStartUsed );
+}
+
+//	same as the above through the nodes of %warpStates% instead of 
+//		this->warpStates, so it reads nothing of the nodes
+void YnxRollingShutterNode::warpOutputToSourcePixels( const std::vector<WarpState> &warpStates,
+														const Vector2 *outputPixels, int numPixels, 
+														Vector2 *sourcePixels_ret, bool *isWarped_ret,
+														Vector2 *partialsX_ret, Vector2 *partialsY_ret,
+														bool isWarmStartUsed /*= true*/ )
+{
+	if( warpStates.empty() )
+	{
+		std::fill( isWarped_ret, isWarped_ret + numPixels, false );
+		return;
+	}
+	
+	//	warp through this node first
+	YnxRollingShutterNode::warpOutputToInputPixels( warpStates[0], outputPixels, numPixels, sourcePixels_ret, isWarped_ret, 
+													partialsX_ret, partialsY_ret, isWarmStartUsed );
+	
+	//	partial derivatives of each concatenated node alone
+	Vector2 *nodePartialsX = NULL,
+			*nodePartialsY = NULL;
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	if( partialsX_ret && warpStates.size() > 1 )
+	{
+		nodePartialsX = scratchArena.allocate<Vector2>( numPixels );
+		nodePartialsY = scratchArena.allocate<Vector2>( numPixels );
+	}
+	
+	//	then the output of each concatenated node is warped to its own input
+	for( size_t i = 1 ; i < warpStates.size() ; i++ )
+	{
+		YnxRollingShutterNode::warpOutputToInputPixels( warpStates[i], sourcePixels_ret, numPixels, sourcePixels_ret, isWarped_ret, 
+														nodePartialsX, nodePartialsY, isWarmStartUsed );
+		if( !partialsX_ret )
+			continue;
+		
+		//	chain rule, partials so far are moved by the jacobian of this node
+		for( int j = 0 ; j < numPixels ; j++ )
+		{
+			if( !isWarped_ret[j] )
+				continue;
+			
+			Vector2 partialX( partialsX_ret[j] ),
+					partialY( partialsY_ret[j] );
+			partialsX_ret[j] = Vector2( nodePartialsX[j].x * partialX.x + nodePartialsY[j].x * partialX.y,
+										nodePartialsX[j].y * partialX.x + nodePartialsY[j].y * partialX.y );
+			partialsY_ret[j] = Vector2( nodePartialsX[j].x * partialY.x + nodePartialsY[j].x * partialY.y,
+										nodePartialsX[j].y * partialY.x + nodePartialsY[j].y * partialY.y );
+		}
+	}
+}
+
+//	warp %numPixels% output pixel positions of the node of %warpState% to the 
+//		positions they sample from its input at once, %inputPixels_ret% may be
+//		%outputPixels%. On entry a false in %isWarped_ret% skips that position, 
+//		on return it tells whether the position is warped. If %partialsX_ret% and 
+//		%partialsY_ret% are given they are filled with the partial derivatives of 
+//		the input position along output x and y ( normalization scales both alike
+//		so they are in pixel too ). When %isWarmStartUsed% is false a reused 
+//		previous frame's inverse is ignored and the warp is removed by solving
+void YnxRollingShutterNode::warpOutputToInputPixels( const WarpState &warpState,
+														const Vector2 *outputPixels, int numPixels, 
+														Vector2 *inputPixels_ret, bool *isWarped_ret,
+														Vector2 *partialsX_ret, Vector2 *partialsY_ret,
+														bool isWarmStartUsed /*= true*/ )
+{
+	//	get width/height and the precomputed engine
+	int inputWidth = warpState.width,
+	    inputHeight = warpState.height;
+	const RollingShutterLensDistortionEngine &engine = warpState.warpData->engine;
+	
+	//	normarlize output positions before warp
+	for( int i = 0 ; i < numPixels ; i++ )
+	{
+		Vector2 normalizedOutputPixel;
+		::normalizePoint( outputPixels[i], inputWidth, inputHeight, 1, &normalizedOutputPixel );
+		inputPixels_ret[i] = normalizedOutputPixel;
+	}
+	
+	if( warpState.isUndistort )
+	{
+		//	skip positions known to be outside of the region where the warp
+		//		can be removed
+		for( int i = 0 ; i < numPixels ; i++ )
+			isWarped_ret[i] = isWarped_ret[i] && warpState.warpData->invertibilityDomain.isInvertible( inputPixels_ret[i] );
+		
+		if( isWarmStartUsed && warpState.warmStartInverse )
+			//	remove warp using the previous frame's inverse
+			YnxRollingShutterNode::removeWarpWithWarmStart( warpState, inputPixels_ret, numPixels, isWarped_ret );
+		else
+			//	remove warp of the whole span and get input positions
+			engine.removeWarpSpan( inputPixels_ret, numPixels, inputPixels_ret, isWarped_ret );
+		
+		//	jacobian of the inverse is the inverse of the jacobian of the warp
+		//		at the solved position
+		if( partialsX_ret )
+		{
+			for( int i = 0 ; i < numPixels ; i++ )
+			{
+				if( !isWarped_ret[i] )
+					continue;
+				
+				Vector2 partialX, partialY;
+				engine.computeWarpJacobian( inputPixels_ret[i], &partialX, &partialY );
+				double determinant = partialX.x * partialY.y - partialY.x * partialX.y;
+				if( determinant == 0 )
+				{
+					//	degenerate, all subsamples fall on the pixel center
+					partialsX_ret[i] = partialsY_ret[i] = Vector2( 0, 0 );
+					continue;
+				}
+				partialsX_ret[i] = Vector2( partialY.y / determinant, -partialX.y / determinant );
+				partialsY_ret[i] = Vector2( -partialY.x / determinant, partialX.x / determinant );
+			}
+		}
+	}
+	else
+	{
+		//	apply warp and get input positions
+		for( int i = 0 ; i < numPixels ; i++ )
+		{
+			if( !isWarped_ret[i] )
+				continue;
+			
+			try
+			{
+				if( partialsX_ret )
+					engine.computeWarpJacobian( inputPixels_ret[i], &partialsX_ret[i], &partialsY_ret[i] );
+				inputPixels_ret[i] = engine.applyWarp( inputPixels_ret[i] );
+			}
+			catch( ynxValueException &e )
+			{
+				//	can't warp this position
+				isWarped_ret[i] = false;
+			}
+		}
+	}
+	
+	//	unnormalize input positions
+	for( int i = 0 ; i < numPixels ; i++ )
+	{
+		Vector2 normalizedInputPixel( inputPixels_ret[i] );
+		::unnormalizePoint( normalizedInputPixel, inputWidth, inputHeight, 1, &inputPixels_ret[i] );
+	}
+}
+
+//	get warp state of this node as validated
+YnxRollingShutterNode::WarpState YnxRollingShutterNode::getWarpState() const
+{
+	WarpState warpState;
+	warpState.warpData = this->warpData;
+	if( this->isWarmStartReused )
+		warpState.warmStartInverse = this->warmStartInverse;
+	warpState.isUndistort = this->isUndistort;
+	warpState.width = this->format().width();
+	warpState.height = this->format().height();
+	
+	return warpState;
+}
+
 	//---------------------------------------------------------------------
 	//	public operator overloads
 	//---------------------------------------------------------------------
@@ -475,9 +843,216 @@ void YnxRollingShutterNode::_request( int x, int y, int r, int t, DD::Image::Cha
 	//---------------------------------------------------------------------
 	//	protected member functions
 	//---------------------------------------------------------------------
+
+//	sample warped positions %sourcePositions% of output pixels [%x%,%r%) in the
+//		row and write them out to %outputs%, with one loop per number of channels
+//	Return false if aborted
+template< bool IS_COARSE_PASS >
+bool YnxRollingShutterNode::sampleRowForNumChannels( int x, int r, 
+													const Vector2 *sourcePositions, const bool *isWarped,
+													const DD::Image::Channel *channels, int numChannels, 
+													float * const *outputs, DD::Image::Pixel &pixel )
+{
+	switch( numChannels )
+	{
+		//	rgb
+		case 3:
+			return this->sampleRow<IS_COARSE_PASS, 3>( x, r, sourcePositions, isWarped, channels, numChannels, outputs, pixel );
+		
+		//	rgba
+		case 4:
+			return this->sampleRow<IS_COARSE_PASS, 4>( x, r, sourcePositions, isWarped, channels, numChannels, outputs, pixel );
+		
+		//	rgba+depth
+		case 5:
+			return this->sampleRow<IS_COARSE_PASS, 5>( x, r, sourcePositions, isWarped, channels, numChannels, outputs, pixel );
+		
+		//	any number of channels
+		default:
+			return this->sampleRow<IS_COARSE_PASS, 0>( x, r, sourcePositions, isWarped, channels, numChannels, outputs, pixel );
+	}
+}
+
+//	sample warped positions %sourcePositions% of output pixels [%x%,%r%) in the
+//		row and write them out to %outputs%, NUM_CHANNELS is the number of
+//		channels known at compile time or 0 to use %numChannels%
+//	Return false if aborted
+template< bool IS_COARSE_PASS, int NUM_CHANNELS >
+bool YnxRollingShutterNode::sampleRow( int x, int r, 
+										const Vector2 *sourcePositions, const bool *isWarped,
+										const DD::Image::Channel *channels, int numChannels, 
+										float * const *outputs, DD::Image::Pixel &pixel )
+{
+	//	number of channels to loop over, a constant for the compiler to unroll
+	//		the channel loops when known
+	const int N = NUM_CHANNELS > 0 ? NUM_CHANNELS : numChannels;
+	
+	//	loop all position in this row ( x ) 
+	//		and sample the warped position
+	for( int i = 0 ; x < r ; x++, i++ )
+	{
+		//	stop immediately when this render is stale
+		if( x % ABORT_CHECK_INTERVAL == 0 && this->aborted() )
+			return false;
+		
+		//	if can't warp position
+		//		set that position pixel value to black 
+		if( !isWarped[i] )
+		{
+			for( int c = 0 ; c < N ; c++ )
+				outputs[c][x] = 0;
+			continue;
+		}
+		
+		const Vector2 &sourcePositionXYYnxVector = sourcePositions[i];
+		if( IS_COARSE_PASS )
+		{
+			//	get nearest pixel value in the coarse pass
+			this->sourceIop->sample( sourcePositionXYYnxVector.x + 0.5f, 
+								sourcePositionXYYnxVector.y + 0.5f,
+								1.0f,
+								1.0f,
+								&this->nearestFilter,
+								pixel );
+		}
+		
+		else
+		{
+			//	get pixel value to set to image
+			this->sourceIop->sample( 
+								//	llx
+								sourcePositionXYYnxVector.x + 0.5f, 
+								//	lly
+								sourcePositionXYYnxVector.y + 0.5f,
+								//	size to get data x ( in pixel )
+								1.0f,
+								//	size to get data y ( in pixel )
+								1.0f,
+								//	pixel result
+								pixel );
+		}
+		
+		//	loop all channel and set value that we get
+		for( int c = 0 ; c < N ; c++ )
+			outputs[c][x] = pixel[channels[c]];
+	}
+	
+	return true;
+}
+
+//	sample %supersampling% x %supersampling% subsamples of each output pixel [%x%,%r%)
+//		in the row and write their average out to %outputs%, with one loop per number
+//		of channels. Subsamples are placed around %sourcePositions% by the partial
+//		derivatives %partialsX% and %partialsY%, %channelSums% holds %numChannels% floats
+//	Return false if aborted
+bool YnxRollingShutterNode::supersampleRowForNumChannels( int x, int r, 
+															const Vector2 *sourcePositions, const bool *isWarped,
+															const Vector2 *partialsX, const Vector2 *partialsY, int supersampling,
+															const DD::Image::Channel *channels, int numChannels, 
+															float * const *outputs, float *channelSums, DD::Image::Pixel &pixel )
+{
+	switch( numChannels )
+	{
+		//	rgb
+		case 3:
+			return this->supersampleRow<3>( x, r, sourcePositions, isWarped, partialsX, partialsY, supersampling,
+											channels, numChannels, outputs, channelSums, pixel );
+		
+		//	rgba
+		case 4:
+			return this->supersampleRow<4>( x, r, sourcePositions, isWarped, partialsX, partialsY, supersampling,
+											channels, numChannels, outputs, channelSums, pixel );
+		
+		//	rgba+depth
+		case 5:
+			return this->supersampleRow<5>( x, r, sourcePositions, isWarped, partialsX, partialsY, supersampling,
+											channels, numChannels, outputs, channelSums, pixel );
+		
+		//	any number of channels
+		default:
+			return this->supersampleRow<0>( x, r, sourcePositions, isWarped, partialsX, partialsY, supersampling,
+											channels, numChannels, outputs, channelSums, pixel );
+	}
+}
+
+//	sample %supersampling% x %supersampling% subsamples of each output pixel [%x%,%r%)
+//		in the row and write their average out to %outputs%, NUM_CHANNELS is the
+//		number of channels known at compile time or 0 to use %numChannels%
+//	Return false if aborted
+template< int NUM_CHANNELS >
+bool YnxRollingShutterNode::supersampleRow( int x, int r, 
+											const Vector2 *sourcePositions, const bool *isWarped,
+											const Vector2 *partialsX, const Vector2 *partialsY, int supersampling,
+											const DD::Image::Channel *channels, int numChannels, 
+											float * const *outputs, float *channelSums, DD::Image::Pixel &pixel )
+{
+	//	number of channels to loop over, a constant for the compiler to unroll
+	//		the channel loops when known
+	const int N = NUM_CHANNELS > 0 ? NUM_CHANNELS : numChannels;
+	
+	//	size of a subsample in the output and weight of a subsample in the average
+	float subsampleSize = 1.0f / supersampling,
+			subsampleWeight = subsampleSize * subsampleSize;
+	
+	//	loop all position in this row ( x ) 
+	//		and sample the subsamples around the warped position
+	for( int i = 0 ; x < r ; x++, i++ )
+	{
+		//	stop immediately when this render is stale
+		if( x % ABORT_CHECK_INTERVAL == 0 && this->aborted() )
+			return false;
+		
+		//	if can't warp position
+		//		set that position pixel value to black 
+		if( !isWarped[i] )
+		{
+			for( int c = 0 ; c < N ; c++ )
+				outputs[c][x] = 0;
+			continue;
+		}
+		
+		//	size of a subsample in the source is the bounding box of the
+		//		subsample square moved by the jacobian
+		const Vector2 &sourcePosition = sourcePositions[i],
+						&partialX = partialsX[i],
+						&partialY = partialsY[i];
+		float sourceSubsampleWidth = subsampleSize * float( fabs( partialX.x ) + fabs( partialY.x ) ),
+				sourceSubsampleHeight = subsampleSize * float( fabs( partialX.y ) + fabs( partialY.y ) );
+		
+		for( int c = 0 ; c < N ; c++ )
+			channelSums[c] = 0;
+		
+		//	subsample centers are evenly spread over the output pixel
+		for( int sy = 0 ; sy < supersampling ; sy++ )
+		{
+			double offsetY = ( sy + 0.5 ) * subsampleSize - 0.5;
+			for( int sx = 0 ; sx < supersampling ; sx++ )
+			{
+				double offsetX = ( sx + 0.5 ) * subsampleSize - 0.5;
+				
+				//	extrapolate the subsample's warped position from the pixel center
+				this->sourceIop->sample( float( sourcePosition.x + partialX.x * offsetX + partialY.x * offsetY ) + 0.5f,
+									float( sourcePosition.y + partialX.y * offsetX + partialY.y * offsetY ) + 0.5f,
+									sourceSubsampleWidth,
+									sourceSubsampleHeight,
+									pixel );
+				
+				for( int c = 0 ; c < N ; c++ )
+					channelSums[c] += pixel[channels[c]];
+			}
+		}
+		
+		//	loop all channel and set the average
+		for( int c = 0 ; c < N ; c++ )
+			outputs[c][x] = channelSums[c] * subsampleWeight;
+	}
+	
+	return true;
+}
+
 																		
 //	get bounding box from given $x, $y, $r, $t
-DD::Image::Box YnxRollingShutterNode::getBoundingBox( int x, int y, int r, int t )
+DD::Image::Box YnxRollingShutterNode::getBoundingBox( int x, int y, int r, int t, int numSamples /*= 32*/ ) const
 {
 	//	normalize given input into 0 - 1
 	double xIn_unit = double( x ) / this->format().width();
@@ -490,13 +1065,13 @@ DD::Image::Box YnxRollingShutterNode::getBoundingBox( int x, int y, int r, int t
 	//	in case undistort do compute bounding box by warp position with undistort
 	if( this->isUndistort )
 	{
-		this->computeUndistortBoundingBox( xIn_unit, yIn_unit, rIn_unit, tIn_unit, &xOut_unit, &yOut_unit, &rOut_unit, &tOut_unit );
+		this->computeUndistortBoundingBox( xIn_unit, yIn_unit, rIn_unit, tIn_unit, &xOut_unit, &yOut_unit, &rOut_unit, &tOut_unit, numSamples, numSamples );
 	}
 	
 	//	in case undistort do compute bounding box by warp position with distort
 	else
 	{
-		this->computeDistortBoundingBox( xIn_unit, yIn_unit, rIn_unit, tIn_unit, &xOut_unit, &yOut_unit, &rOut_unit, &tOut_unit );
+		this->computeDistortBoundingBox( xIn_unit, yIn_unit, rIn_unit, tIn_unit, &xOut_unit, &yOut_unit, &rOut_unit, &tOut_unit, numSamples, numSamples );
 	}
 	
 	//	unnormalize the position  after warped
@@ -509,12 +1084,30 @@ DD::Image::Box YnxRollingShutterNode::getBoundingBox( int x, int y, int r, int t
 	return DD::Image::Box( int( floor( xOut_pixel ) ) - 2, int( floor( yOut_pixel ) ) - 2, int( ceil( rOut_pixel ) ) + 2, int( ceil( tOut_pixel ) ) + 2 );
 }
 
+//	estimate the largest displacement ( in pixel ) along x or y from an
+//		output pixel to its source position through all concatenated nodes,
+//		from how far the warp of each node moved the edges of its input's
+//		bounding box
+double YnxRollingShutterNode::estimateMaxDisplacement() const
+{
+	double maxDisplacement = 0;
+	for( size_t i = 0 ; i <= this->concatenatedNodes.size() ; i++ )
+	{
+		const YnxRollingShutterNode *node = i == 0 ? this : this->concatenatedNodes[i - 1];
+		const int *boundingBox = node->warpData->boundingBox;
+		const DD::Image::Box &inputBoundingBox = node->input0().info();
+		maxDisplacement += std::max( std::max( abs( boundingBox[0] - inputBoundingBox.x() ), abs( boundingBox[1] - inputBoundingBox.y() ) ),
+										std::max( abs( boundingBox[2] - inputBoundingBox.r() ), abs( boundingBox[3] - inputBoundingBox.t() ) ) );
+	}
+	return maxDisplacement * MAX_DISPLACEMENT_ESTIMATE_SCALE + MAX_DISPLACEMENT_ESTIMATE_PADDING;
+}
+
 	//---------------------------------------------------------------------
 	//	private member functions
 	//---------------------------------------------------------------------
 
 //	compute bounding box by sample the position and warp to get bounding box
-void YnxRollingShutterNode::computeDistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX /*= 32*/, int numSampleY /*= 32*/ )
+void YnxRollingShutterNode::computeDistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX /*= 32*/, int numSampleY /*= 32*/ ) const
 {
 	//	initialize the output x, y, r, t ( r = max number of x ( width ), t = max number of y ( height ) )
 	//		to compute and get min/max value to decide as bounding box
@@ -549,7 +1142,7 @@ void YnxRollingShutterNode::computeDistortBoundingBox( double x, double y, doubl
 		this->getDistortMinMaxBoundingBox( r, sampleT, x_ret, y_ret, r_ret, t_ret );
 	}
 }
-void YnxRollingShutterNode::computeUndistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX /*= 32*/, int numSampleY /*= 32*/ )
+void YnxRollingShutterNode::computeUndistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX /*= 32*/, int numSampleY /*= 32*/ ) const
 {
 	//	initialize the output x, y, r, t ( r = max number of x ( width ), t = max number of y ( height ) )
 	//		to compute and get min/max value to decide as bounding box
@@ -590,7 +1183,7 @@ void YnxRollingShutterNode::computeUndistortBoundingBox( double x, double y, dou
 //	get bounding box from given input pixel position by do warp position then
 //			check is the output position is exceed the min, max or not
 //			if exceed change the value to the new one
-void YnxRollingShutterNode::getDistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret )
+void YnxRollingShutterNode::getDistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret ) const
 {
 	//	construct ynx vector2 ( rolling shutter engines use ynx vector2 to warp position )
 	//		for input and output
@@ -614,7 +1207,7 @@ void YnxRollingShutterNode::getDistortMinMaxBoundingBox( double x, double y, dou
 	*r_ret = std::max( *r_ret, outputVec.x );
 	*t_ret = std::max( *t_ret, outputVec.y );
 }
-void YnxRollingShutterNode::getUndistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret )
+void YnxRollingShutterNode::getUndistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret ) const
 {
 	//	construct ynx vector2 ( rolling shutter engines use ynx vector2 to warp position )
 	//		for input and output	
@@ -639,6 +1232,294 @@ void YnxRollingShutterNode::getUndistortMinMaxBoundingBox( double x, double y, d
 	*t_ret = std::max( *t_ret, outputVec.y );
 }
 
+//	compute hash of the warp parameters of this render, %motion% replaces
+//		the motion of the engine when given
+uint64_t YnxRollingShutterNode::computeWarpHash( const RollingShutterSingleFrameMotion *motion /*= NULL*/ ) const
+{
+	return this->rollingShutterLensDistortionEngine.computeParameterHash( motion ) ^ uint64_t( this->isUndistort );
+}
+
+//	check if a render of warp parameters hashed %warpHash% starts with the
+//		coarse pass, which is whenever they changed in a gui session
+bool YnxRollingShutterNode::isCoarsePassPending( uint64_t warpHash ) const
+{
+	return DD::Image::Application::gui && this->isProgressive && warpHash != this->refinedWarpHash;
+}
+
+//	compute key of the warp data of this node from everything it depends on
+uint64_t YnxRollingShutterNode::computeWarpDataKey( bool for_real ) const
+{
+	//	warp parameters and mode
+	uint64_t key = this->rollingShutterLensDistortionEngine.computeParameterHash();
+	key = WarpDataCache::combineKey( key, this->isUndistort );
+	
+	//	the coarse grid and invertibility domain are only built for real
+	key = WarpDataCache::combineKey( key, this->isCoarsePass );
+	key = WarpDataCache::combineKey( key, for_real );
+	
+	//	format and input bounding box
+	key = WarpDataCache::combineKey( key, this->format().width() );
+	key = WarpDataCache::combineKey( key, this->format().height() );
+	key = WarpDataCache::combineKey( key, this->input0().info().x() );
+	key = WarpDataCache::combineKey( key, this->input0().info().y() );
+	key = WarpDataCache::combineKey( key, this->input0().info().r() );
+	key = WarpDataCache::combineKey( key, this->input0().info().t() );
+	
+	//	concatenated nodes change the source positions of the coarse grid
+	for( size_t i = 0 ; i < this->concatenatedNodes.size() ; i++ )
+		key = WarpDataCache::combineKey( key, this->concatenatedNodes[i]->warpDataKey );
+	
+	return key;
+}
+
+//	compute warp data of this node ( when it isn't in the cache )
+std::shared_ptr<const WarpData> YnxRollingShutterNode::computeWarpData( bool for_real )
+{
+	std::shared_ptr<WarpData> warpData = std::make_shared<WarpData>();
+	
+	//	precompute the rolling shutter warp 
+	this->rollingShutterLensDistortionEngine.precompute();
+
+#ifdef DEBUG_VALIDATE
+	std::cout << "		this->getBottomPointWarpOffset(X,Y)[0] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(0).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(0).y << std::endl;
+	std::cout << "		this->getBottomPointWarpOffset(X,Y)[1] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(1).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(1).y << std::endl;
+	std::cout << "		this->getBottomPointWarpOffset(X,Y)[2] = " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(2).x << ", " << this->rollingShutterLensDistortionEngine.getBottomPointWarpOffset(2).y << std::endl;
+
+	std::cout << "		this->getTopPointWarpOffset(X,Y)[0] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(0).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(0).y << std::endl;
+	std::cout << "		this->getTopPointWarpOffset(X,Y)[1] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(1).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(1).y << std::endl;
+	std::cout << "		this->getTopPointWarpOffset(X,Y)[2] = " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(2).x << ", " << this->rollingShutterLensDistortionEngine.getTopPointWarpOffset(2).y << std::endl;		
+#endif
+		
+	warpData->engine = this->rollingShutterLensDistortionEngine;
+	
+	//	compute bounding box by sampling point and warp to get min, max to decide as bounding box
+	//		( with fewer samples in the coarse pass )
+	DD::Image::Box boundingBox = this->getBoundingBox( this->input0().info().x(), 
+							  this->input0().info().y(), 
+							  this->input0().info().r(), 
+							  this->input0().info().t(),
+							  this->isCoarsePass ? NUM_COARSE_BOUNDING_BOX_SAMPLES : NUM_BOUNDING_BOX_SAMPLES );
+	warpData->boundingBox[0] = boundingBox.x();
+	warpData->boundingBox[1] = boundingBox.y();
+	warpData->boundingBox[2] = boundingBox.r();
+	warpData->boundingBox[3] = boundingBox.t();
+	
+	//	get output bounding box
+	DD::Image::Box outputBoundingBox = this->info_;
+	outputBoundingBox.merge( boundingBox );
+	
+	//	compute region where the warp can be removed once for all rows of the output,
+	//		so engine can skip positions where removeWarp would fail anyway
+	if( this->isUndistort && for_real )
+	{
+		int width = this->format().width(),
+			height = this->format().height();
+		Vector2 normalizedLowerLeft, normalizedUpperRight;
+		::normalizePoint( Vector2( outputBoundingBox.x(), outputBoundingBox.y() ), width, height, 1, &normalizedLowerLeft );
+		::normalizePoint( Vector2( outputBoundingBox.r(), outputBoundingBox.t() ), width, height, 1, &normalizedUpperRight );
+		warpData->invertibilityDomain.compute( this->rollingShutterLensDistortionEngine,
+												normalizedLowerLeft.x, normalizedUpperRight.x,
+												normalizedLowerLeft.y, 1.0 / width, outputBoundingBox.t() - outputBoundingBox.y(),
+												INVERTIBILITY_DOMAIN_TOLERANCE / width );
+	}
+	
+	//	warp data is used from here on to build the coarse grid
+	this->warpData = warpData;
+	
+	//	coarse grid over the output bounding box
+	if( this->isCoarsePass && for_real )
+		this->buildCoarseWarpGrid( outputBoundingBox, &warpData->coarseWarpGrid );
+	
+	return warpData;
+}
+
+//	fill %warpGrid_ret% with source positions over %box%
+void YnxRollingShutterNode::buildCoarseWarpGrid( const DD::Image::Box &box, WarpGrid *warpGrid_ret ) const
+{
+	warpGrid_ret->resize( box.x(), box.y(), box.r(), box.t(), COARSE_WARP_GRID_SPACING );
+	
+	//	warp every grid node, nodes that can't be warped stay invalid
+	for( int j = 0 ; j < warpGrid_ret->getNumNodesY() ; j++ )
+	{
+		for( int i = 0 ; i < warpGrid_ret->getNumNodesX() ; i++ )
+		{
+			Vector2 sourcePosition;
+			bool isValid = this->warpOutputToSourcePixel( warpGrid_ret->getNodePosition( i, j ), &sourcePosition );
+			warpGrid_ret->setNodeValue( i, j, sourcePosition, isValid );
+		}
+	}
+	
+	//	the coarse pass samples the nearest pixel, far coarser than the encoding
+	warpGrid_ret->compact();
+}
+
+//	find the previous frame's inverse of this node and use it as is when it is 
+//		within this->warmStartTolerance, else solve a new one starting from it
+void YnxRollingShutterNode::updateWarmStartInverse()
+{
+	//	one inverse per node, view and format ( normalized positions depend on
+	//		the format )
+	int width = this->format().width(),
+		height = this->format().height();
+	std::string key = this->node_name() + ":" + std::to_string( this->outputContext().view() ) + 
+						":" + std::to_string( width ) + "x" + std::to_string( height );
+	WarmStartCache &warmStartCache = WarmStartCache::getInstance();
+	std::shared_ptr<const WarmStartInverse> previous = warmStartCache.find( key );
+	
+	//	use the previous frame's inverse as is when its error against this
+	//		frame's warp is within the tolerance. A warp offset difference is
+	//		stretched by up to maxInverseStretch in the inverse, which is only
+	//		an estimate since this frame's stretch differs, so a grid passing it
+	//		is confirmed by solving a sample of positions with this frame's warp
+	if( previous )
+	{
+		double offsetDifference = this->rollingShutterLensDistortionEngine.computeMaxWarpOffsetDifference( previous->engine );
+		double estimatedError = ( offsetDifference * previous->maxInverseStretch + previous->maxInterpolationError ) * width;
+		if( estimatedError <= this->warmStartTolerance )
+		{
+			double maxInverseStretch = previous->maxInverseStretch;
+			double measuredError = previous->measureMaxError( this->rollingShutterLensDistortionEngine, &maxInverseStretch ) * width;
+
+			//	re-estimate with the stretch of this frame's warp at the samples
+			estimatedError = ( offsetDifference * maxInverseStretch + previous->maxInterpolationError ) * width;
+			if( measuredError <= this->warmStartTolerance && estimatedError <= this->warmStartTolerance )
+			{
+				this->warmStartInverse = previous;
+				this->isWarmStartReused = true;
+				return;
+			}
+		}
+	}
+	
+	//	solve a new grid over the output bounding box starting from the previous one
+	Vector2 normalizedBottomLeft, normalizedTopRight;
+	::normalizePoint( Vector2( this->info_.x(), this->info_.y() ), width, height, 1, &normalizedBottomLeft );
+	::normalizePoint( Vector2( this->info_.r(), this->info_.t() ), width, height, 1, &normalizedTopRight );
+	std::shared_ptr<WarmStartInverse> warmStartInverse( new WarmStartInverse );
+	warmStartInverse->compute( this->rollingShutterLensDistortionEngine, 
+								normalizedBottomLeft.x, normalizedBottomLeft.y, 
+								normalizedTopRight.x, normalizedTopRight.y, 
+								double( WARM_START_GRID_SPACING ) / width,
+								previous.get() );
+	warmStartCache.insert( key, warmStartInverse );
+	
+	this->warmStartInverse = warmStartInverse;
+	this->isWarmStartReused = false;
+}
+
+//	replace motion of the engine by the motion of the current frame in
+//		this->motionSidecarPath when it is set
+void YnxRollingShutterNode::updateMotionFromSidecar()
+{
+	this->motionSidecarError.clear();
+	this->motionSidecarWarning.clear();
+	if( this->motionSidecarPath == NULL || this->motionSidecarPath[0] == '\0' )
+	{
+		this->motionSidecarIndex.reset();
+		return;
+	}
+	
+	//	the index is shared by every op of every node reading the sidecar
+	try
+	{
+		this->motionSidecarIndex = MotionSidecarIndex::open( this->motionSidecarPath, this->gyroConversion );
+	}
+	catch( ynxValueException &e )
+	{
+		this->motionSidecarIndex.reset();
+		this->motionSidecarError = e.what();
+		return;
+	}
+	
+	int frame = int( floor( this->outputContext().frame() + 0.5 ) );
+	if( !this->motionSidecarIndex->getFrameMotion( frame, this->rollingShutterLensDistortionEngine.getCurrentMotionDataPtr() ) )
+		this->motionSidecarWarning = "no motion for frame " + std::to_string( frame ) + " in " + 
+										this->motionSidecarPath + ", using the motion knobs";
+}
+
+//	read source positions of the output bounding box from the file of this 
+//		frame in this->displacementCacheDirectory, computing and saving them
+//		when there is no such file yet outside of gui sessions
+void YnxRollingShutterNode::updateDisplacementCacheFile()
+{
+	//	the warp data key covers everything the source positions depend on,
+	//		and is the same on every machine
+	this->displacementCacheFile = DisplacementCacheFile::open( this->displacementCacheDirectory, this->warpDataKey );
+	if( this->displacementCacheFile )
+		return;
+	
+	//	a gui session only reads files, building one would stall every knob
+	//		change and fill the directory with frames never rendered again
+	if( DD::Image::Application::gui )
+		return;
+	
+	//	warp every pixel of the output bounding box once, in Nuke's number of threads,
+	//		until the render is aborted. Concatenated nodes may reuse their previous 
+	//		frame's inverse, it is ignored so the file doesn't depend on the frame 
+	//		rendered before
+	int x = this->info_.x(),
+		y = this->info_.y(),
+		r = this->info_.r(),
+		t = this->info_.t();
+	if( r <= x || t <= y )
+		return;
+	const std::vector<WarpState> &warpStates = this->warpStates;
+	FrameWarpMap frameWarpMap( x, y, r, t, this->estimateMaxDisplacement(),
+								[&warpStates]( const Vector2 *outputPixels, int numPixels, Vector2 *sourcePixels_ret, bool *isWarped_ret )
+								{ 
+									YnxRollingShutterNode::warpOutputToSourcePixels( warpStates, outputPixels, numPixels, 
+																					sourcePixels_ret, isWarped_ret, NULL, NULL, false ); 
+								},
+								[this]() { return this->aborted(); } );
+	if( frameWarpMap.getMaxError() > DISPLACEMENT_CACHE_MAX_ERROR )
+		return;
+	if( !frameWarpMap.build( std::max( 1, int( DD::Image::Thread::numThreads ) ) ) )
+		return;
+	
+	//	a frame which can't be saved ( e.g. read only directory, or displacements
+	//		beyond the estimate ) is rendered as usual
+	if( frameWarpMap.getNumOutOfRangePixels() > 0 )
+		return;
+	this->displacementCacheFile = DisplacementCacheFile::write( this->displacementCacheDirectory, this->warpDataKey, 
+																x, y, r, t, frameWarpMap.getEncodedDisplacements(), 
+																frameWarpMap.getDisplacementEncoding(), DISPLACEMENT_CACHE_MAX_ERROR );
+}
+
+//	set this->warpStates from this node and the concatenated nodes
+void YnxRollingShutterNode::updateWarpStates()
+{
+	this->warpStates.assign( 1, this->getWarpState() );
+	for( size_t i = 0 ; i < this->concatenatedNodes.size() ; i++ )
+		this->warpStates.push_back( this->concatenatedNodes[i]->getWarpState() );
+}
+
+//	remove warp of %numPixels% normalized positions %pixels% in place by
+//		interpolating the inverse of %warpState%, positions outside of it are 
+//		solved. On entry a false in %isWarped_ret% skips that position, on
+//		return it tells whether the position is warped
+void YnxRollingShutterNode::removeWarpWithWarmStart( const WarpState &warpState, Vector2 *pixels, int numPixels, bool *isWarped_ret )
+{
+	ScratchArena &scratchArena = ScratchArena::getThreadInstance();
+	ScratchArena::Scope scratchScope( scratchArena );
+	bool *isInterpolated = scratchArena.allocate<bool>( numPixels ),
+		*isSolved = scratchArena.allocate<bool>( numPixels );
+	
+	//	use the previous frame's inverse as is where it covers the position
+	const WarpGrid &grid = warpState.warmStartInverse->grid;
+	for( int i = 0 ; i < numPixels ; i++ )
+	{
+		Vector2 interpolatedPixel;
+		isInterpolated[i] = isWarped_ret[i] && grid.interpolate( pixels[i], &interpolatedPixel );
+		if( isInterpolated[i] )
+			pixels[i] = interpolatedPixel;
+		isSolved[i] = isWarped_ret[i] && !isInterpolated[i];
+	}
+	
+	//	solve the rest
+	warpState.warpData->engine.removeWarpSpan( pixels, numPixels, pixels, isSolved );
+	for( int i = 0 ; i < numPixels ; i++ )
+		isWarped_ret[i] = isInterpolated[i] || isSolved[i];
+}
 
 /*! This is a function that creates an instance of the operator, and is
    needed for the Iop::Description to work.
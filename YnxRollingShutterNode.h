@@ -14,11 +14,17 @@
 //
 //---------------------------------------------------------------------
 
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
 //	Nuke
 #include <DDImage/Iop.h>
 #include <DDImage/Knobs.h>
 #include <DDImage/Row.h>
 #include <DDImage/Filter.h>
+#include <DDImage/Pixel.h>
 
 //---------------------------------------------------------------------
 //
@@ -29,6 +35,27 @@
 //	yannix lens distortion engine
 #include "RollingShutterLensDistortionEngine.h"
 
+//	coarse grid of warped positions
+#include "WarpGrid.h"
+
+//	process wide cache of precomputed warp data
+#include "WarpDataCache.h"
+
+//	previous frame's inverse of every node
+#include "WarmStartCache.h"
+
+//	per frame motion read from a sidecar
+#include "MotionSidecarIndex.h"
+
+//	source positions saved to disk
+#include "DisplacementCacheFile.h"
+
+//	source positions of a whole frame warped in parallel
+#include "FrameWarpMap.h"
+
+//	end of the coarse pass of a progressive render
+#include "CoarsePassTracker.h"
+
 //---------------------------------------------------------------------
 //
 //	DEFINES
@@ -60,7 +87,9 @@ const char * const HELP = "YnxRollingShutterNode\n"
 "A rolling shutter ratio of +1 results in the top of the image warped to the position at next frame, "
 "and the bottom of the image warped to the position of the previous frame. A rolling shutter ratio "
 "of -1 results in the top of the image warped to the position at previous frame, and the bottom of "
-"the image warped to the position of the next frame.";
+"the image warped to the position of the next frame. Radial ( k1, k2, k3 ) and tangential ( p1, p2 ) "
+"lens distortion can be applied before or after the rolling shutter in the same resample. "
+"\"supersampling\" averages NxN samples per output pixel against aliasing where the warp minifies.";
 
 //	command for this node when create in nuke ( just like node name for creating in nuke )
 const char * const CLASS = "YnxRollingShutterNode";
@@ -82,6 +111,31 @@ class YnxRollingShutterNode : public DD::Image::Iop
 	//	public member classes
 	//---------------------------------------------------------------------
 	public:
+		
+		//	everything the span warp of a node reads, held by value so threads
+		//		warping in the background keep it alive and unchanged while the
+		//		node ( or an upstream one ) is validated again
+		class WarpState
+		{
+			public:
+				//	warp data, its engine is the precomputed engine of the node
+				std::shared_ptr<const WarpData> warpData;
+				
+				//	previous frame's inverse interpolated instead of solving
+				//		( empty when not reused )
+				std::shared_ptr<const WarmStartInverse> warmStartInverse;
+				
+				//	is undistort, and format size of the node
+				bool isUndistort;
+				int width, height;
+				
+			public:
+				//contructors/destructors
+				WarpState() : isUndistort( false ), width( 0 ), height( 0 )
+				{
+					
+				}
+		};
 
 	//---------------------------------------------------------------------
 	//	public member data
@@ -105,6 +159,118 @@ class YnxRollingShutterNode : public DD::Image::Iop
 		
 		//	is undistort
 		bool isUndistort;
+		
+		//	is concatenate with upstream rolling shutter nodes
+		bool isConcatenate;
+		
+		//	is render progressively ( coarse then full quality ) in gui sessions
+		bool isProgressive;
+		
+		//	number of subsamples along x and y of every output pixel ( 1 is a
+		//		single sample ), subsamples are extrapolated from the warp of the
+		//		pixel center by its jacobian
+		int supersampling;
+		
+		//----------------------------------
+		//	concatenation
+		//
+		
+		//	upstream rolling shutter nodes whose warps are composed into
+		//		this node's resample ( nearest first )
+		std::vector<const YnxRollingShutterNode *> concatenatedNodes;
+		
+		//	warp state of this node then of every concatenated node, set in
+		//		_validate
+		std::vector<WarpState> warpStates;
+		
+		//	op which is actually sampled in engine, this is input0 when
+		//		there is nothing to concatenate
+		DD::Image::Iop *sourceIop;
+		
+		//----------------------------------
+		//	progressive rendering
+		//
+		
+		//	is this render the coarse pass of a progressive render ( decided
+		//		in _validate, engine only reads it )
+		bool isCoarsePass;
+		
+		//	hash of warp parameters of this render, and of the last
+		//		render whose coarse pass has finished
+		uint64_t warpHash;
+		std::atomic<uint64_t> refinedWarpHash;
+		
+		//	rows rendered in the coarse pass, renders in full quality once it
+		//		is done ( empty when not in the coarse pass )
+		std::unique_ptr<CoarsePassTracker> coarsePassTracker;
+		
+		//----------------------------------
+		//	shared warp data
+		//
+		
+		//	key of this->warpData in the process wide WarpDataCache
+		uint64_t warpDataKey;
+		
+		//	precomputed warp data shared with every instance with identical
+		//		parameters ( bounding box and coarse grid of source positions )
+		std::shared_ptr<const WarpData> warpData;
+		
+		//	nearest filter used to sample in the coarse pass
+		DD::Image::Filter nearestFilter;
+		
+		//----------------------------------
+		//	warm start
+		//
+		
+		//	is start undistort from the previous frame rendered by this node, and
+		//		error allowed to use the previous frame's inverse as is ( in pixel )
+		bool isWarmStart;
+		double warmStartTolerance;
+		
+		//	inverse of this frame, or of the previous frame when it is used as is
+		//		( empty when warm start is off )
+		std::shared_ptr<const WarmStartInverse> warmStartInverse;
+		
+		//	is this->warmStartInverse interpolated instead of solving
+		bool isWarmStartReused;
+		
+		//----------------------------------
+		//	motion sidecar
+		//
+		
+		//	path of the sidecar the motion of every frame is read from instead of
+		//		the motion knobs ( empty to use the knobs ), and how gyro samples in
+		//		it are converted to motion
+		const char *motionSidecarPath;
+		GyroConversion gyroConversion;
+		
+		//	index of this->motionSidecarPath ( empty when not used ), and why the
+		//		sidecar or this frame's motion in it couldn't be read
+		std::shared_ptr<const MotionSidecarIndex> motionSidecarIndex;
+		std::string motionSidecarError, motionSidecarWarning;
+		
+		//----------------------------------
+		//	displacement cache
+		//
+		
+		//	directory source positions of whole frames are saved to and read
+		//		from ( empty to compute them in every render )
+		const char *displacementCacheDirectory;
+		
+		//	source positions of this frame read from the directory ( empty
+		//		when not used )
+		std::shared_ptr<const DisplacementCacheFile> displacementCacheFile;
+		
+		//----------------------------------
+		//	eager warp
+		//
+		
+		//	is warp the whole frame in parallel before engine
+		bool isEagerWarp;
+		
+		//	source positions of this frame warped by blocks in parallel, engine 
+		//		waits only for the block of its row ( empty when not used )
+		std::unique_ptr<FrameWarpMap> frameWarpMap;
 	
 	//---------------------------------------------------------------------
 	//	private member data
@@ -166,9 +332,56 @@ class YnxRollingShutterNode : public DD::Image::Iop
 		//	This function is used for request region of data before send into engine func
 		void _request(int x, int y, int r, int t, DD::Image::ChannelMask channels, int count);
 		
+		//	This function is called before the first engine call, and when the node
+		//		won't be rendered for a while
+		virtual void _open();
+		virtual void _close();
+		
+		//	This function is used for add values that affect the output but not stored in knobs
+		//		into the hash of this node
+		virtual void append( DD::Image::Hash &hash );
+		
 		//	Function for create knob ( knobs are fundamentals of all user interface elements available to NUKE Ops. )
 		//		For more information https://learn.foundry.com/nuke/developers/63/ndkdevguide/knobs-and-handles/index.html
 		virtual void knobs( DD::Image::Knob_Callback f );
+		
+		//	warp an output pixel position of this node to the position it samples
+		//		from its input, return false if the position can't be warped
+		bool warpOutputToInputPixel( const Vector2 &outputPixel, Vector2 *inputPixel_ret ) const;
+		
+		//	warp an output pixel position of this node through all concatenated
+		//		nodes to the position it samples from this->sourceIop
+		bool warpOutputToSourcePixel( const Vector2 &outputPixel, Vector2 *sourcePixel_ret ) const;
+		
+		//	span version of the above for %numPixels% positions at once, the
+		//		result may overwrite %outputPixels%. On entry a false in %isWarped_ret%
+		//		skips that position, on return it tells whether the position is warped.
+		//		If %partialsX_ret% and %partialsY_ret% are given they are filled with the
+		//		partial derivatives of the warped position along output x and y. When
+		//		%isWarmStartUsed% is false a reused previous frame's inverse is ignored
+		//		and the warp is removed by solving
+		void warpOutputToSourcePixels( const Vector2 *outputPixels, int numPixels, 
+										Vector2 *sourcePixels_ret, bool *isWarped_ret,
+										Vector2 *partialsX_ret = NULL, Vector2 *partialsY_ret = NULL,
+										bool isWarmStartUsed = true ) const;
+		
+		//	same as the above through the nodes of %warpStates% instead of 
+		//		this->warpStates, so it reads nothing of the nodes
+		static void warpOutputToSourcePixels( const std::vector<WarpState> &warpStates,
+												const Vector2 *outputPixels, int numPixels, 
+												Vector2 *sourcePixels_ret, bool *isWarped_ret,
+												Vector2 *partialsX_ret = NULL, Vector2 *partialsY_ret = NULL,
+												bool isWarmStartUsed = true );
+		
+		//	same as the above through the node of %warpState% only
+		static void warpOutputToInputPixels( const WarpState &warpState,
+												const Vector2 *outputPixels, int numPixels, 
+												Vector2 *inputPixels_ret, bool *isWarped_ret,
+												Vector2 *partialsX_ret = NULL, Vector2 *partialsY_ret = NULL,
+												bool isWarmStartUsed = true );
+		
+		//	get warp state of this node as validated
+		WarpState getWarpState() const;
 				
 	//---------------------------------------------------------------------
 	//	public operator overloads
@@ -181,7 +394,42 @@ class YnxRollingShutterNode : public DD::Image::Iop
 	protected:
 	
 		//	get bounding box from given $x, $y, $r, $t
-		DD::Image::Box getBoundingBox( int x, int y, int r, int t );
+		DD::Image::Box getBoundingBox( int x, int y, int r, int t, int numSamples = 32 ) const;
+		
+		//	estimate the largest displacement ( in pixel ) along x or y from an
+		//		output pixel to its source position through all concatenated nodes
+		double estimateMaxDisplacement() const;
+		
+		//	sample warped positions %sourcePositions% of output pixels [%x%,%r%) in the
+		//		row and write them out to %outputs%, specialized for the progressive 
+		//		pass and the number of channels ( NUM_CHANNELS 0 for any number )
+		//	Return false if aborted
+		template< bool IS_COARSE_PASS >
+		bool sampleRowForNumChannels( int x, int r, 
+										const Vector2 *sourcePositions, const bool *isWarped,
+										const DD::Image::Channel *channels, int numChannels, 
+										float * const *outputs, DD::Image::Pixel &pixel );
+		template< bool IS_COARSE_PASS, int NUM_CHANNELS >
+		bool sampleRow( int x, int r, 
+						const Vector2 *sourcePositions, const bool *isWarped,
+						const DD::Image::Channel *channels, int numChannels, 
+						float * const *outputs, DD::Image::Pixel &pixel );
+		
+		//	same as this->sampleRowForNumChannels with %supersampling% x %supersampling% 
+		//		subsamples per output pixel, placed around %sourcePositions% by the 
+		//		partial derivatives %partialsX% and %partialsY% and averaged.
+		//		%channelSums% holds %numChannels% floats
+		bool supersampleRowForNumChannels( int x, int r, 
+											const Vector2 *sourcePositions, const bool *isWarped,
+											const Vector2 *partialsX, const Vector2 *partialsY, int supersampling,
+											const DD::Image::Channel *channels, int numChannels, 
+											float * const *outputs, float *channelSums, DD::Image::Pixel &pixel );
+		template< int NUM_CHANNELS >
+		bool supersampleRow( int x, int r, 
+								const Vector2 *sourcePositions, const bool *isWarped,
+								const Vector2 *partialsX, const Vector2 *partialsY, int supersampling,
+								const DD::Image::Channel *channels, int numChannels, 
+								float * const *outputs, float *channelSums, DD::Image::Pixel &pixel );
 	
 	//---------------------------------------------------------------------
 	//	private member functions
@@ -189,14 +437,53 @@ class YnxRollingShutterNode : public DD::Image::Iop
 	private:
 		
 		//	compute bounding box by sample the position and warp to get bounding box
-		void computeDistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX = 32, int numSampleY = 32 );
- 		void computeUndistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX = 32, int numSampleY = 32 );
+		void computeDistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX = 32, int numSampleY = 32 ) const;
+ 		void computeUndistortBoundingBox( double x, double y, double r, double t, double *x_ret, double *y_ret, double *r_ret, double *t_ret, int numSampleX = 32, int numSampleY = 32 ) const;
 		
 		//	get bounding box from given input pixel position by do warp position then
 		//			check is the output position is exceed the min, max or not
 		//			if exceed change the value to the new one
-		void getDistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret );
-		void getUndistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret );
+		void getDistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret ) const;
+		void getUndistortMinMaxBoundingBox( double x, double y, double *x_ret, double *y_ret, double *r_ret, double *t_ret ) const;
+		
+		//	compute hash of the warp parameters of this render, %motion% replaces
+		//		the motion of the engine when given
+		uint64_t computeWarpHash( const RollingShutterSingleFrameMotion *motion = NULL ) const;
+		
+		//	check if a render of warp parameters hashed %warpHash% starts with the
+		//		coarse pass
+		bool isCoarsePassPending( uint64_t warpHash ) const;
+		
+		//	compute key of the warp data of this node from everything it depends on
+		uint64_t computeWarpDataKey( bool for_real ) const;
+		
+		//	compute warp data of this node ( when it isn't in the cache )
+		std::shared_ptr<const WarpData> computeWarpData( bool for_real );
+		
+		//	fill %warpGrid_ret% with source positions over %box%
+		void buildCoarseWarpGrid( const DD::Image::Box &box, WarpGrid *warpGrid_ret ) const;
+		
+		//	find the previous frame's inverse of this node and use it as is when it is 
+		//		within this->warmStartTolerance, else solve a new one starting from it
+		void updateWarmStartInverse();
+		
+		//	replace motion of the engine by the motion of the current frame in
+		//		this->motionSidecarPath when it is set
+		void updateMotionFromSidecar();
+		
+		//	read source positions of the output bounding box from the file of this 
+		//		frame in this->displacementCacheDirectory, computing and saving them
+		//		when there is no such file yet outside of gui sessions
+		void updateDisplacementCacheFile();
+		
+		//	set this->warpStates from this node and the concatenated nodes
+		void updateWarpStates();
+		
+		//	remove warp of %numPixels% normalized positions %pixels% in place by
+		//		interpolating the inverse of %warpState%, positions outside of it are 
+		//		solved. On entry a false in %isWarped_ret% skips that position, on
+		//		return it tells whether the position is warped
+		static void removeWarpWithWarmStart( const WarpState &warpState, Vector2 *pixels, int numPixels, bool *isWarped_ret );
 	
 };
 //---------------------------------------------------------------------
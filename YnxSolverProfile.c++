@@ -0,0 +1,487 @@
+//---------------------------------------------------------------------
+//
+//	Program written for
+//		Yannix 2026/10/18
+//	Copyright Yannix (Thailand) Co., Ltd 2026. All rights reserved
+//
+//---------------------------------------------------------------------
+
+//	ynxsolverprofile : sweep rolling shutter ratios and motion magnitudes through
+//		InvertWarpFuncs over a grid of image positions, write per position heatmaps
+//		of the solver's work and print percentiles of the solve cost
+//
+//	usage : ynxsolverprofile [options] outputPrefix
+//		-ratios r0,r1,...	rolling shutter ratios ( default -1,-0.5,0.5,1 )
+//		-scales s0,s1,...	multipliers of the motion ( default 1,2,4 )
+//		-size WxH			image size, for aspect and errors in pixel ( default 1920x1080 )
+//		-grid WxH			number of solved positions ( default 240x135 )
+//		-sidecar path		take the motion from a motion sidecar ( see MotionSidecarIndex )
+//		-frame f			frame of the sidecar ( default 1 )
+//		-solver name		newton or bracketed ( default newton )
+//		-format name		pfm, csv or both ( default both )
+//
+//	For every ratio and scale outputPrefix_r<ratio>_s<scale>_<map>.pfm is written
+//		for maps iterations, stepHalvings, finalError ( in pixel ) and failed, and
+//		outputPrefix_r<ratio>_s<scale>.csv with one line per position. The summary
+//		is printed and written to outputPrefix_summary.csv. The cost of a solve is
+//		its number of warp evaluations, 1 + iterations + step halvings.
+
+//---------------------------------------------------------------------
+//
+//	STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//
+//	NON-STANDARD INCLUDES
+//
+//---------------------------------------------------------------------
+
+#include "RollingShutterLensDistortionEngine.h"
+#include "InvertWarpFuncs.h"
+#include "PointNormalization.h"
+#include "MotionSidecarIndex.h"
+
+//---------------------------------------------------------------------
+//	DEFINES AND INLINES
+//---------------------------------------------------------------------
+
+//	default motion when no sidecar is given, every point moves by a pan
+//		plus a rotation about the center over one frame ( in NDC )
+#define DEFAULT_PAN_X 0.05
+#define DEFAULT_PAN_Y 0.02
+#define DEFAULT_ROTATION 0.02
+
+//---------------------------------------------------------------------
+//	GLOBALS
+//---------------------------------------------------------------------
+
+//	options of a sweep
+struct ProfileOptions
+{
+	std::vector<double> ratios, scales;
+	int imageWidth, imageHeight;
+	int gridWidth, gridHeight;
+	std::string sidecarPath;
+	int frame;
+	int inverseSolver;
+	bool isWritePfm, isWriteCsv;
+	std::string outputPrefix;
+};
+
+//	work of the solve of one position
+struct PositionProfile
+{
+	float numIterations, numStepHalvings, finalError, isFailed;
+	double microseconds;
+};
+
+//---------------------------------------------------------------------
+//	FILE SCOPE FUNCTION PROTOTYPES
+//---------------------------------------------------------------------
+
+static void printUsage();
+static bool parseList( const char *text, std::vector<double> *values_ret );
+static bool parseSize( const char *text, int *width_ret, int *height_ret );
+static bool parseOptions( int argc, char **argv, ProfileOptions *options_ret );
+static RollingShutterSingleFrameMotion makeDefaultMotion();
+static RollingShutterSingleFrameMotion scaleMotion( const RollingShutterSingleFrameMotion &motion, double scale );
+static double computePercentile( const std::vector<double> &sortedValues, double fraction );
+static bool writePfm( const std::string &path, const std::vector<PositionProfile> &profiles,
+						int width, int height, float PositionProfile::*member );
+static bool writeCsv( const std::string &path, const std::vector<PositionProfile> &profiles,
+						const std::vector<Vector2> &pixels );
+
+//---------------------------------------------------------------------
+//	FUNCTION BODIES
+//---------------------------------------------------------------------
+
+//	print command line usage
+static void printUsage()
+{
+	std::cerr << "usage : ynxsolverprofile [options] outputPrefix\n"
+				"	-ratios r0,r1,...	rolling shutter ratios ( default -1,-0.5,0.5,1 )\n"
+				"	-scales s0,s1,...	multipliers of the motion ( default 1,2,4 )\n"
+				"	-size WxH		image size ( default 1920x1080 )\n"
+				"	-grid WxH		number of solved positions ( default 240x135 )\n"
+				"	-sidecar path		take the motion from a motion sidecar\n"
+				"	-frame f		frame of the sidecar ( default 1 )\n"
+				"	-solver name		newton or bracketed ( default newton )\n"
+				"	-format name		pfm, csv or both ( default both )" << std::endl;
+}
+
+//	parse comma separated numbers of %text%
+//	returns false if any isn't a number
+static bool parseList( const char *text, std::vector<double> *values_ret )
+{
+	values_ret->clear();
+	std::stringstream stream( text );
+	std::string item;
+	while( std::getline( stream, item, ',' ) )
+	{
+		char *end;
+		double value = strtod( item.c_str(), &end );
+		if( item.empty() || *end != '\0' )
+			return false;
+		values_ret->push_back( value );
+	}
+	return !values_ret->empty();
+}
+
+//	parse %text% of the form WxH
+//	returns false if it isn't two positive integers
+static bool parseSize( const char *text, int *width_ret, int *height_ret )
+{
+	return sscanf( text, "%dx%d", width_ret, height_ret ) == 2 && *width_ret > 0 && *height_ret > 0;
+}
+
+//	parse command line into %options_ret%
+//	returns false if it isn't valid
+static bool parseOptions( int argc, char **argv, ProfileOptions *options_ret )
+{
+	::parseList( "-1,-0.5,0.5,1", &options_ret->ratios );
+	::parseList( "1,2,4", &options_ret->scales );
+	options_ret->imageWidth = 1920;
+	options_ret->imageHeight = 1080;
+	options_ret->gridWidth = 240;
+	options_ret->gridHeight = 135;
+	options_ret->frame = 1;
+	options_ret->inverseSolver = INVERSE_SOLVER_NEWTON;
+	options_ret->isWritePfm = options_ret->isWriteCsv = true;
+
+	for( int i = 1 ; i < argc ; i++ )
+	{
+		std::string option( argv[i] );
+
+		//	the last argument is the output prefix
+		if( option[0] != '-' )
+		{
+			if( i != argc - 1 )
+				return false;
+			options_ret->outputPrefix = option;
+			continue;
+		}
+
+		//	every option has a value
+		if( i + 1 >= argc )
+			return false;
+		const char *value = argv[++i];
+
+		if( option == "-ratios" )
+		{
+			if( !::parseList( value, &options_ret->ratios ) )
+				return false;
+		}
+		else if( option == "-scales" )
+		{
+			if( !::parseList( value, &options_ret->scales ) )
+				return false;
+		}
+		else if( option == "-size" )
+		{
+			if( !::parseSize( value, &options_ret->imageWidth, &options_ret->imageHeight ) )
+				return false;
+		}
+		else if( option == "-grid" )
+		{
+			if( !::parseSize( value, &options_ret->gridWidth, &options_ret->gridHeight ) )
+				return false;
+		}
+		else if( option == "-sidecar" )
+			options_ret->sidecarPath = value;
+		else if( option == "-frame" )
+			options_ret->frame = atoi( value );
+		else if( option == "-solver" )
+		{
+			if( strcmp( value, "newton" ) == 0 )
+				options_ret->inverseSolver = INVERSE_SOLVER_NEWTON;
+			else if( strcmp( value, "bracketed" ) == 0 )
+				options_ret->inverseSolver = INVERSE_SOLVER_BRACKETED;
+			else
+				return false;
+		}
+		else if( option == "-format" )
+		{
+			options_ret->isWritePfm = strcmp( value, "pfm" ) == 0 || strcmp( value, "both" ) == 0;
+			options_ret->isWriteCsv = strcmp( value, "csv" ) == 0 || strcmp( value, "both" ) == 0;
+			if( !options_ret->isWritePfm && !options_ret->isWriteCsv )
+				return false;
+		}
+		else
+			return false;
+	}
+
+	return !options_ret->outputPrefix.empty();
+}
+
+//	get motion of a pan plus a rotation about the center
+static RollingShutterSingleFrameMotion makeDefaultMotion()
+{
+	RollingShutterSingleFrameMotion motion;
+	for( int i = 0 ; i < 3 ; i++ )
+	{
+		Vector2 top( RollingShutterLensDistortionEngine::getTopPointPosition( i ) ),
+				bottom( RollingShutterLensDistortionEngine::getBottomPointPosition( i ) ),
+				topOffset( DEFAULT_PAN_X - DEFAULT_ROTATION * top.y, DEFAULT_PAN_Y + DEFAULT_ROTATION * top.x ),
+				bottomOffset( DEFAULT_PAN_X - DEFAULT_ROTATION * bottom.y, DEFAULT_PAN_Y + DEFAULT_ROTATION * bottom.x );
+		motion.top[i].set( top - topOffset, top + topOffset );
+		motion.bottom[i].set( bottom - bottomOffset, bottom + bottomOffset );
+	}
+	return motion;
+}
+
+//	get %motion% with every point's offsets from its still position
+//		multiplied by %scale%
+static RollingShutterSingleFrameMotion scaleMotion( const RollingShutterSingleFrameMotion &motion, double scale )
+{
+	RollingShutterSingleFrameMotion scaledMotion;
+	for( int i = 0 ; i < 3 ; i++ )
+	{
+		Vector2 top( RollingShutterLensDistortionEngine::getTopPointPosition( i ) ),
+				bottom( RollingShutterLensDistortionEngine::getBottomPointPosition( i ) );
+		Vector2 topPreviousOffset( motion.top[i].previousPosition - top ),
+				topNextOffset( motion.top[i].nextPosition - top ),
+				bottomPreviousOffset( motion.bottom[i].previousPosition - bottom ),
+				bottomNextOffset( motion.bottom[i].nextPosition - bottom );
+		topPreviousOffset.multiply( scale );
+		topNextOffset.multiply( scale );
+		bottomPreviousOffset.multiply( scale );
+		bottomNextOffset.multiply( scale );
+		scaledMotion.top[i].set( top + topPreviousOffset, top + topNextOffset );
+		scaledMotion.bottom[i].set( bottom + bottomPreviousOffset, bottom + bottomNextOffset );
+	}
+	return scaledMotion;
+}
+
+//	get value at %fraction% of %sortedValues% ( nearest rank )
+static double computePercentile( const std::vector<double> &sortedValues, double fraction )
+{
+	if( sortedValues.empty() )
+		return 0;
+	size_t index = size_t( ceil( fraction * sortedValues.size() ) );
+	return sortedValues[std::min( std::max( index, size_t( 1 ) ), sortedValues.size() ) - 1];
+}
+
+//	write %member% of %profiles% ( row major from the bottom row ) as a
+//		single channel little endian PFM
+//	returns false if it can't be written
+static bool writePfm( const std::string &path, const std::vector<PositionProfile> &profiles,
+						int width, int height, float PositionProfile::*member )
+{
+	FILE *file = fopen( path.c_str(), "wb" );
+	if( file == NULL )
+		return false;
+
+	//	a negative scale is little endian, PFM rows run bottom to top like the grid
+	fprintf( file, "Pf\n%d %d\n-1.0\n", width, height );
+	std::vector<float> row( width );
+	bool isWritten = true;
+	for( int j = 0 ; j < height && isWritten ; j++ )
+	{
+		for( int i = 0 ; i < width ; i++ )
+			row[i] = profiles[j * width + i].*member;
+		isWritten = fwrite( row.data(), sizeof( float ), width, file ) == size_t( width );
+	}
+
+	return fclose( file ) == 0 && isWritten;
+}
+
+//	write %profiles% of %pixels% as CSV
+//	returns false if it can't be written
+static bool writeCsv( const std::string &path, const std::vector<PositionProfile> &profiles,
+						const std::vector<Vector2> &pixels )
+{
+	FILE *file = fopen( path.c_str(), "w" );
+	if( file == NULL )
+		return false;
+
+	fprintf( file, "x,y,iterations,stepHalvings,finalError,failed,microseconds\n" );
+	for( size_t i = 0 ; i < profiles.size() ; i++ )
+	{
+		const PositionProfile &profile = profiles[i];
+		fprintf( file, "%g,%g,%d,%d,%g,%d,%.3f\n", pixels[i].x, pixels[i].y,
+					int( profile.numIterations ), int( profile.numStepHalvings ),
+					profile.finalError, int( profile.isFailed ), profile.microseconds );
+	}
+
+	return fclose( file ) == 0;
+}
+
+int main( int argc, char **argv )
+{
+	ProfileOptions options;
+	if( !::parseOptions( argc, argv, &options ) )
+	{
+		::printUsage();
+		return 1;
+	}
+
+	//	motion to sweep
+	RollingShutterSingleFrameMotion baseMotion;
+	if( options.sidecarPath.empty() )
+		baseMotion = ::makeDefaultMotion();
+	else
+	{
+		try
+		{
+			std::shared_ptr<const MotionSidecarIndex> sidecar = MotionSidecarIndex::open( options.sidecarPath, GyroConversion() );
+			if( !sidecar->getFrameMotion( options.frame, &baseMotion ) )
+			{
+				std::cerr << "ynxsolverprofile : frame " << options.frame << " isn't in " << options.sidecarPath << std::endl;
+				return 1;
+			}
+		}
+		catch( ynxValueException &e )
+		{
+			std::cerr << "ynxsolverprofile : " << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	//	solved positions at the centers of grid cells, in pixel and normalized
+	int numPositions = options.gridWidth * options.gridHeight;
+	std::vector<Vector2> pixels( numPositions ), normalizedPixels( numPositions );
+	for( int j = 0 ; j < options.gridHeight ; j++ )
+	{
+		for( int i = 0 ; i < options.gridWidth ; i++ )
+		{
+			int index = j * options.gridWidth + i;
+			pixels[index] = Vector2( ( i + 0.5 ) * options.imageWidth / options.gridWidth,
+										( j + 0.5 ) * options.imageHeight / options.gridHeight );
+			::normalizePoint( pixels[index], options.imageWidth, options.imageHeight, 1, &normalizedPixels[index] );
+		}
+	}
+
+	//	summary of every parameter set
+	std::string summaryPath = options.outputPrefix + "_summary.csv";
+	FILE *summaryFile = fopen( summaryPath.c_str(), "w" );
+	if( summaryFile == NULL )
+	{
+		std::cerr << "ynxsolverprofile : can't write " << summaryPath << std::endl;
+		return 1;
+	}
+	fprintf( summaryFile, "ratio,scale,solves,failures,costP50,costP90,costP99,costMax,"
+							"microsecondsP50,microsecondsP90,microsecondsP99,microsecondsMax,maxFinalError\n" );
+	printf( "%8s %6s %8s %8s %6s %6s %6s %6s %8s %8s %8s %8s\n", "ratio", "scale", "solves", "failed%",
+			"cost50", "cost90", "cost99", "costMx", "us50", "us90", "us99", "usMax" );
+
+	std::vector<PositionProfile> profiles( numPositions );
+	std::vector<double> costs, microseconds;
+	for( size_t r = 0 ; r < options.ratios.size() ; r++ )
+	{
+		for( size_t s = 0 ; s < options.scales.size() ; s++ )
+		{
+			RollingShutterLensDistortionEngine engine;
+			*engine.getCurrentMotionDataPtr() = ::scaleMotion( baseMotion, options.scales[s] );
+			engine.setRollingShutterRatio( options.ratios[r] );
+			engine.precompute();
+
+			//	solve every position from the engine's usual initial guess
+			costs.clear();
+			microseconds.clear();
+			int numFailures = 0;
+			double maxFinalError = 0;
+			for( int i = 0 ; i < numPositions ; i++ )
+			{
+				const Vector2 &q = normalizedPixels[i];
+				InvertWarpStats stats;
+				bool isFailed = false;
+				std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+				try
+				{
+					Vector2 initialGuess( engine.predictRemoveRollingShutterWarp( q ) );
+					if( options.inverseSolver == INVERSE_SOLVER_BRACKETED )
+						InvertWarpFuncs::removeWarpBracketed( engine, initialGuess, q, DEFAULT_NUMERICAL_ERROR, &stats );
+					else
+						InvertWarpFuncs::removeWarp( engine, initialGuess, q, DEFAULT_NUMERICAL_ERROR, &stats );
+				}
+				catch( ynxValueException &e )
+				{
+					isFailed = true;
+				}
+				std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+				PositionProfile &profile = profiles[i];
+				profile.numIterations = stats.numIterations;
+				profile.numStepHalvings = stats.numStepHalvings;
+				profile.finalError = float( sqrt( stats.finalSqrError ) * options.imageWidth );
+				profile.isFailed = isFailed;
+				profile.microseconds = std::chrono::duration<double, std::micro>( endTime - startTime ).count();
+
+				costs.push_back( 1 + stats.numIterations + stats.numStepHalvings );
+				microseconds.push_back( profile.microseconds );
+				numFailures += isFailed;
+				if( !isFailed )
+					maxFinalError = std::max( maxFinalError, double( profile.finalError ) );
+			}
+
+			//	heatmaps
+			char name[64];
+			snprintf( name, sizeof( name ), "_r%g_s%g", options.ratios[r], options.scales[s] );
+			std::string prefix = options.outputPrefix + name;
+			bool isWritten = true;
+			if( options.isWritePfm )
+			{
+				isWritten = ::writePfm( prefix + "_iterations.pfm", profiles, options.gridWidth, options.gridHeight,
+										&PositionProfile::numIterations ) &&
+							::writePfm( prefix + "_stepHalvings.pfm", profiles, options.gridWidth, options.gridHeight,
+										&PositionProfile::numStepHalvings ) &&
+							::writePfm( prefix + "_finalError.pfm", profiles, options.gridWidth, options.gridHeight,
+										&PositionProfile::finalError ) &&
+							::writePfm( prefix + "_failed.pfm", profiles, options.gridWidth, options.gridHeight,
+										&PositionProfile::isFailed );
+			}
+			if( options.isWriteCsv )
+				isWritten = isWritten && ::writeCsv( prefix + ".csv", profiles, pixels );
+			if( !isWritten )
+			{
+				std::cerr << "ynxsolverprofile : can't write " << prefix << "*" << std::endl;
+				fclose( summaryFile );
+				return 1;
+			}
+
+			//	percentiles
+			std::sort( costs.begin(), costs.end() );
+			std::sort( microseconds.begin(), microseconds.end() );
+			double costPercentiles[4] = { ::computePercentile( costs, 0.5 ), ::computePercentile( costs, 0.9 ),
+											::computePercentile( costs, 0.99 ), costs.back() },
+					microsecondPercentiles[4] = { ::computePercentile( microseconds, 0.5 ), ::computePercentile( microseconds, 0.9 ),
+												::computePercentile( microseconds, 0.99 ), microseconds.back() };
+			printf( "%8g %6g %8d %8.3f %6g %6g %6g %6g %8.3f %8.3f %8.3f %8.3f\n", options.ratios[r], options.scales[s],
+					numPositions, 100.0 * numFailures / numPositions,
+					costPercentiles[0], costPercentiles[1], costPercentiles[2], costPercentiles[3],
+					microsecondPercentiles[0], microsecondPercentiles[1], microsecondPercentiles[2], microsecondPercentiles[3] );
+			fprintf( summaryFile, "%g,%g,%d,%d,%g,%g,%g,%g,%.3f,%.3f,%.3f,%.3f,%g\n", options.ratios[r], options.scales[s],
+						numPositions, numFailures,
+						costPercentiles[0], costPercentiles[1], costPercentiles[2], costPercentiles[3],
+						microsecondPercentiles[0], microsecondPercentiles[1], microsecondPercentiles[2], microsecondPercentiles[3],
+						maxFinalError );
+		}
+	}
+
+	if( fclose( summaryFile ) != 0 )
+	{
+		std::cerr << "ynxsolverprofile : can't write " << summaryPath << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+//---------------------------------------------------------------------
+//
+//	EOF
+//
+//---------------------------------------------------------------------
+
@@ -3,3 +3,4 @@ import nuke
 nuke.menu("Nodes").addMenu("Yannix")
  
 nuke.menu("Nodes").addCommand( "Yannix/YnxRollingShutterNode", "nuke.createNode('YnxRollingShutterNode')" )
+nuke.menu("Nodes").addCommand( "Yannix/YnxDeepRollingShutterNode", "nuke.createNode('YnxDeepRollingShutterNode')" )